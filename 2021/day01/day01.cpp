@@ -2,70 +2,124 @@
 // Day 1: Sonar Sweep
 // https://adventofcode.com/2021/day/1
 
-#include <charconv>
+#include <algorithm>
+#include <cstdint>
 #include <fstream>
 #include <iostream>
-#include <numeric>
 #include <string>
 #include <vector>
 
 #include <gsl/util>
 
-static bool readFile(std::string fileName, std::vector<std::string> &lines)
+using Depth = int32_t;
+constexpr size_t blockSize{4096};
+
+// Counts increases of sums over sliding windows of width w in constant memory:
+// sum(a[i + 1] ... a[i + w]) > sum(a[i] ... a[i + w - 1]) if and only if a[i + w] > a[i]
+class SonarSweep
 {
-    std::ifstream in{fileName.c_str()};
+public:
+    SonarSweep(size_t window) : window{window}, block(window + blockSize)
+    {
+    }
+
+    void add(const Depth* depths, size_t size)
+    {
+        while (size > 0) {
+            const auto n{std::min(size, block.size() - fill)};
+            std::copy(depths, depths + n, block.begin() + fill);
+            fill += n;
+            depths += n;
+            size -= n;
+            if (fill == block.size()) {
+                flush();
+            }
+        }
+    }
+
+    size_t getIncreases()
+    {
+        flush();
+        return increases;
+    }
+
+private:
+    // Compares all new pairs of the block, the last window depths are kept for the next block
+    void flush()
+    {
+        if (fill <= window) {
+            return;
+        }
+        const auto n{fill - window};
+        const auto* a = block.data();
+        const auto* b = a + window;
+        // Branch-free loop over contiguous blocks, which compilers turn into vector compares
+        size_t count{0};
+        for (size_t i = 0; i < n; ++i) {
+            count += b[i] > a[i];
+        }
+        increases += count;
+        std::copy(block.cbegin() + n, block.cbegin() + fill, block.begin());
+        fill = window;
+    }
+
+    size_t window;
+    std::vector<Depth> block;
+    size_t fill{0};
+    size_t increases{0};
+};
+
+// Parses the depths of a file chunk by chunk and passes them on in batches
+template <typename Sink>
+static bool readDepths(const std::string& fileName, Sink sink)
+{
+    std::ifstream in{fileName.c_str(), std::ios::binary};
     if (!in) {
         std::cerr << "Cannot open file " << fileName << std::endl;
         return false;
     }
     auto closeStream = gsl::finally([&in] { in.close(); });
-    std::string str;
-    while (std::getline(in, str)) {
-        lines.push_back(str);
+    std::vector<char> buffer(size_t{1} << 16);
+    std::vector<Depth> depths{};
+    depths.reserve(buffer.size() / 2 + 1);
+    Depth depth{0};
+    bool isNumber{false};
+    while (in.read(buffer.data(), buffer.size()) || in.gcount() > 0) {
+        const auto size{static_cast<size_t>(in.gcount())};
+        for (size_t i = 0; i < size; ++i) {
+            const auto c{buffer[i]};
+            if (c >= '0' && c <= '9') {
+                depth = depth * 10 + (c - '0');
+                isNumber = true;
+            } else if (isNumber) {
+                depths.push_back(depth);
+                depth = 0;
+                isNumber = false;
+            }
+        }
+        sink(depths.data(), depths.size());
+        depths.clear();
+    }
+    if (isNumber) {
+        sink(&depth, 1);
     }
     return true;
 }
 
-inline static std::vector<int> toInt(std::vector<std::string> &lines)
+int main(int argc, char* argv[])
 {
-    std::vector<int> data;
-    data.reserve(lines.size());
-    std::transform(lines.cbegin(), lines.cend(), std::back_inserter(data), [](const std::string &line) {
-        int val{0};
-        std::from_chars(line.data(), line.data() + line.size(), val);
-        return val;
-    });
-    return data;
-}
-
-static size_t countIncreases(std::vector<int> &data)
-{
-    std::adjacent_difference(data.begin(), data.end(), data.begin());
-    data.erase(data.begin());
-    return std::count_if(data.cbegin(), data.cend(), [](int i) { return i > 0; });
-}
-
-int main(int argc, char *argv[])
-{
-    std::vector<std::string> lines;
+    SonarSweep sweep1{1};
+    SonarSweep sweep3{3};
     if (argc == 2) {
-        if (!readFile(argv[1], lines)) {
+        if (!readDepths(argv[1], [&](const Depth* depths, size_t size) {
+                sweep1.add(depths, size);
+                sweep3.add(depths, size);
+            })) {
             return EXIT_FAILURE;
         }
     }
 
-    {
-        auto data{toInt(lines)};
-        std::cout << countIncreases(data) << std::endl;
-    }
-    {
-        auto data{toInt(lines)};
-        std::vector<int> data3;
-        data3.reserve(data.size() - 2);
-        for (auto val = data.cbegin(); val != data.cend() - 2; val++) {
-            data3.push_back(std::accumulate(val, val + 3, 0));
-        }
-        std::cout << countIncreases(data3) << std::endl;
-    }
+    std::cout << sweep1.getIncreases() << std::endl;
+    std::cout << sweep3.getIncreases() << std::endl;
     return EXIT_SUCCESS;
 }
@@ -2,11 +2,12 @@
 // Day 3: Binary Diagnostic
 // https://adventofcode.com/2021/day/3
 
+#include <algorithm>
 #include <array>
 #include <bitset>
+#include <cstdint>
 #include <fstream>
 #include <iostream>
-#include <sstream>
 #include <string>
 #include <vector>
 
@@ -27,35 +28,107 @@ static bool readFile(std::string fileName, std::vector<std::string>& lines)
     return true;
 }
 
-constexpr size_t bits{12};
+using Word = uint64_t;
+constexpr size_t maxBits{64};
 
-inline static std::vector<std::bitset<bits> > toBitset(std::vector<std::string>& lines)
+inline static std::vector<Word> toWords(const std::vector<std::string>& lines, size_t bits)
 {
-    std::vector<std::bitset<bits> > data;
+    std::vector<Word> data;
     data.reserve(lines.size());
     std::transform(lines.cbegin(), lines.cend(), std::back_inserter(data),
-                   [](const std::string& line) { return std::bitset<bits>(line); });
+                   [bits](const std::string& line) { return std::bitset<maxBits>(line, 0, bits).to_ullong(); });
     return data;
 }
 
-template <typename Cmp>
-static unsigned long eraseAllButOne(std::vector<std::bitset<bits> >& data)
+// Transposes a 64x64 bit matrix in place by swapping blocks of halving size
+static void transpose(std::array<Word, 64>& m)
 {
-    Cmp cmp;
-    for (auto i = bits - 1; i > 0; i--) {
-        if (data.size() == 1) {
-            break;
+    Word mask{0x00000000FFFFFFFFull};
+    for (size_t j = 32; j != 0; j >>= 1, mask ^= mask << j) {
+        for (size_t k = 0; k < 64; k = (k + j + 1) & ~j) {
+            const auto t{(m[k] ^ (m[k + j] >> j)) & mask};
+            m[k] ^= t;
+            m[k + j] ^= t << j;
         }
-        const auto count{std::count_if(data.cbegin(), data.cend(), [i](const auto& b) { return b[i - 1]; })};
-        const bool remove{cmp(count, data.size() / 2.)};
-        data.erase(std::remove_if(data.begin(), data.end(), [&](const auto& b) { return b[i - 1] == remove; }),
-                   data.end());
     }
-    return data[0].to_ulong();
 }
 
-constexpr auto keepMostCommonBit = eraseAllButOne<std::less<double> >;
-constexpr auto keepLeastCommonBit = eraseAllButOne<std::greater_equal<double> >;
+// Number of set bits per column, counted 64 words at a time by popcounts of the transposed block
+static std::array<size_t, maxBits> countColumns(const std::vector<Word>& data)
+{
+    std::array<size_t, maxBits> counts{};
+    for (size_t i = 0; i < data.size(); i += 64) {
+        std::array<Word, 64> block{};
+        std::copy(data.cbegin() + i, data.cbegin() + std::min(i + 64, data.size()), block.begin());
+        transpose(block);
+        for (size_t k = 0; k < 64; ++k) {
+            counts[k] += std::bitset<64>(block[k]).count();
+        }
+    }
+    // Row k of the transposed block holds bit 63 - k of each word
+    std::reverse(counts.begin(), counts.end());
+    return counts;
+}
+
+// Walks the implicit binary trie of the sorted words, keeping the more (or less) common half per bit
+template <bool mostCommon>
+static Word findRating(const std::vector<Word>& sorted, size_t bits)
+{
+    auto first{sorted.cbegin()};
+    auto last{sorted.cend()};
+    for (auto i = bits; i > 0 && std::distance(first, last) > 1; --i) {
+        const Word bit{Word{1} << (i - 1)};
+        const auto mid{std::partition_point(first, last, [bit](const auto& w) { return (w & bit) == 0; })};
+        const auto zeros{std::distance(first, mid)};
+        const auto ones{std::distance(mid, last)};
+        if (zeros == 0 || ones == 0) {
+            continue;
+        }
+        if (mostCommon == (ones >= zeros)) {
+            first = mid;
+        } else {
+            last = mid;
+        }
+    }
+    return *first;
+}
+
+// Decimal digits of the full 128-bit product, computed on 32-bit limbs such that it does not depend on a compiler
+// specific 128-bit type
+static std::string multiply(Word a, Word b)
+{
+    const std::array<uint64_t, 2> x{a & UINT32_MAX, a >> 32};
+    const std::array<uint64_t, 2> y{b & UINT32_MAX, b >> 32};
+    // Least significant limb first
+    std::array<uint32_t, 4> limbs{};
+    for (size_t i = 0; i < 2; ++i) {
+        uint64_t carry{0};
+        for (size_t j = 0; j < 2; ++j) {
+            const auto t{x[i] * y[j] + limbs[i + j] + carry};
+            limbs[i + j] = static_cast<uint32_t>(t);
+            carry = t >> 32;
+        }
+        limbs[i + 2] = static_cast<uint32_t>(carry);
+    }
+    std::string digits{};
+    do {
+        // Divide by 10^9 and append the remainder as the next nine digits
+        uint64_t rem{0};
+        for (size_t k = limbs.size(); k-- > 0;) {
+            const auto cur{(rem << 32) | limbs[k]};
+            limbs[k] = static_cast<uint32_t>(cur / 1000000000);
+            rem = cur % 1000000000;
+        }
+        for (size_t d = 0; d < 9; ++d, rem /= 10) {
+            digits.push_back(static_cast<char>('0' + rem % 10));
+        }
+    } while (std::any_of(limbs.cbegin(), limbs.cend(), [](const auto limb) { return limb != 0; }));
+    while (digits.size() > 1 && digits.back() == '0') {
+        digits.pop_back();
+    }
+    std::reverse(digits.begin(), digits.end());
+    return digits;
+}
 
 int main(int argc, char* argv[])
 {
@@ -65,32 +138,31 @@ int main(int argc, char* argv[])
             return EXIT_FAILURE;
         }
     }
+    lines.erase(std::remove(lines.begin(), lines.end(), std::string{}), lines.end());
+    if (lines.empty() || lines[0].size() > maxBits) {
+        return EXIT_FAILURE;
+    }
 
-    auto data{toBitset(lines)};
+    const auto bits{lines[0].size()};
+    auto data{toWords(lines, bits)};
     {
-        auto size{data.size()};
-        std::bitset<bits> rate;
-        for (size_t i = bits; i > 0; i--) {
-            const auto count{std::count_if(data.cbegin(), data.cend(), [i](const auto& b) { return b[i - 1]; })};
-            rate[i - 1] = count >= size / 2.;
+        const auto counts{countColumns(data)};
+        const Word all{bits == maxBits ? ~Word{0} : (Word{1} << bits) - 1};
+        Word gamma{0};
+        for (size_t i = 0; i < bits; ++i) {
+            if (counts[i] >= data.size() / 2.) {
+                gamma |= Word{1} << i;
+            }
         }
-        const auto gamma{rate.to_ulong()};
-        const auto eps{rate.flip().to_ulong()};
-        std::cout << gamma * eps << std::endl;
+        const auto eps{~gamma & all};
+        std::cout << multiply(gamma, eps) << std::endl;
     }
     {
-        // Use first selection to split data into two parts
-        const auto count{std::count_if(data.cbegin(), data.cend(), [](const auto& b) { return b[bits - 1]; })};
-        const auto remove{count < data.size() / 2.};
-        auto p{std::stable_partition(data.begin(), data.end(), [&](const auto& b) { return b[bits - 1] != remove; })};
-        std::vector<std::bitset<bits> > data2;
-        data2.insert(data2.end(), std::make_move_iterator(p), std::make_move_iterator(data.end()));
-        data.erase(p, data.end());
-
-        const auto o2{keepMostCommonBit(data)};
-        const auto co2{keepLeastCommonBit(data2)};
+        std::sort(data.begin(), data.end());
+        const auto o2{findRating<true>(data, bits)};
+        const auto co2{findRating<false>(data, bits)};
 
-        std::cout << o2 * co2 << std::endl;
+        std::cout << multiply(o2, co2) << std::endl;
     }
     return EXIT_SUCCESS;
 }
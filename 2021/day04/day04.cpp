@@ -5,13 +5,13 @@
 #define _CRT_SECURE_NO_WARNINGS
 
 #include <algorithm>
-#include <array>
+#include <cstdint>
 #include <fstream>
 #include <iostream>
 #include <numeric>
 #include <sstream>
 #include <string>
-#include <tuple>
+#include <unordered_map>
 #include <vector>
 
 #include <gsl/util>
@@ -32,89 +32,103 @@ static bool readFile(std::string fileName, std::vector<std::string>& lines)
 }
 
 using Number = unsigned long;
-using BoolNumber = std::pair<Number, bool>;
-using Row = std::array<BoolNumber, 5>;
-using Field = std::array<Row, 5>;
+using Board = std::vector<Number>;  // Row-major cells of a square board
 
-struct Bingo
+struct Win
 {
-    void fillNextRow(Row& row)
+    size_t board;
+    Number number;
+    Number score;
+};
+
+// Bingo on any number of square boards of any size, each drawn number is looked up in a reverse index
+class Bingo
+{
+public:
+    Bingo(size_t size) : size{size}
     {
-        if (n < 5) {
-            field[n++].swap(row);
-        }
     }
 
-    bool isBingo() const
+    void addBoard(const Board& board)
     {
-        if (std::any_of(field.cbegin(), field.cend(), [](const auto& row) {
-                return std::all_of(row.cbegin(), row.cend(), [](const auto& v) { return v.second; });
-            })) {
-            return true;
+        const auto offset{cells.size()};
+        cells.insert(cells.end(), board.cbegin(), board.cend());
+        for (size_t i = 0; i < board.size(); ++i) {
+            index[board[i]].push_back(offset + i);
         }
-        return (field[0][0].second && field[1][0].second && field[2][0].second && field[3][0].second &&
-                field[4][0].second) ||
-               (field[0][1].second && field[1][1].second && field[2][1].second && field[3][1].second &&
-                field[4][1].second) ||
-               (field[0][2].second && field[1][2].second && field[2][2].second && field[3][2].second &&
-                field[4][2].second) ||
-               (field[0][3].second && field[1][3].second && field[2][3].second && field[3][3].second &&
-                field[4][3].second) ||
-               (field[0][4].second && field[1][4].second && field[2][4].second && field[3][4].second &&
-                field[4][4].second);
+        unmarked.push_back(std::accumulate(board.cbegin(), board.cend(), Number{0}));
     }
 
-    std::tuple<bool, Number> set(Number num)
+    // All winning boards in draw order in O(boards + draws + hits)
+    std::vector<Win> play(const std::vector<Number>& numbers)
     {
-        for (auto& row : field) {
-            auto p = std::find_if(row.begin(), row.end(), [&](const auto& v) { return v.first == num; });
-            if (p != row.end()) {
-                p->second = true;
+        const auto boards{unmarked.size()};
+        std::vector<uint16_t> rowHits(boards * size, 0);
+        std::vector<uint16_t> colHits(boards * size, 0);
+        std::vector<bool> marked(cells.size(), false);
+        std::vector<bool> won(boards, false);
+        std::vector<Win> wins{};
+        for (const auto& num : numbers) {
+            const auto cellsOfNum{index.find(num)};
+            if (cellsOfNum == index.cend()) {
+                continue;
             }
-        }
-
-        if (isBingo()) {
-            Number score{0};
-            auto acc = [](Number r, const BoolNumber& v) {
-                if (!v.second) {
-                    return r + v.first;
+            for (const auto& cell : cellsOfNum->second) {
+                const auto board{cell / (size * size)};
+                if (won[board] || marked[cell]) {
+                    continue;
+                }
+                marked[cell] = true;
+                unmarked[board] -= num;
+                const auto row{cell / size % size};
+                const auto col{cell % size};
+                const auto isRow{++rowHits[board * size + row] == size};
+                const auto isCol{++colHits[board * size + col] == size};
+                if (isRow || isCol) {
+                    won[board] = true;
+                    wins.push_back({board, num, unmarked[board] * num});
                 }
-                return r;
-            };
-            for (const auto& row : field) {
-                score += std::accumulate(row.cbegin(), row.cend(), 0, acc);
             }
-            return {true, score * num};
         }
-        return {false, 0};
+        return wins;
     }
 
 private:
-    Field field{};
-    size_t n{0};
+    size_t size;
+    std::vector<Number> cells{};
+    std::vector<Number> unmarked{};
+    std::unordered_map<Number, std::vector<size_t> > index{};
 };
 
-using Bingos = std::vector<Bingo>;
-
-static Bingos toBingos(const std::vector<std::string>& lines)
+// Boards separated by empty lines, the size is given by the first row
+static bool toBingo(const std::vector<std::string>& lines, Bingo& bingo)
 {
-    Bingos bingos{};
+    Board board{};
+    size_t size{0};
+    size_t rows{0};
     for (auto it = lines.cbegin() + 1; it != lines.cend(); ++it) {
-        if (it->empty()) {
-            bingos.push_back(Bingo());
+        std::istringstream iss(*it);
+        Number num;
+        while (iss >> num) {
+            board.push_back(num);
+        }
+        if (board.empty()) {
             continue;
         }
-        std::istringstream iss(*it);
-        Row row{};
-        for (size_t i = 0; i < 5; ++i) {
-            Number num;
-            if (iss >> num) {
-                row[i].first = num;
-            }
+        if (size == 0) {
+            size = board.size();
+            bingo = Bingo{size};
+        }
+        if (board.size() != ++rows * size) {
+            return false;
+        }
+        if (rows == size) {
+            bingo.addBoard(board);
+            board.clear();
+            rows = 0;
         }
-        bingos.back().fillNextRow(row);
     }
-    return bingos;
+    return size > 0 && rows == 0;
 }
 
 int main(int argc, char* argv[])
@@ -125,8 +139,11 @@ int main(int argc, char* argv[])
             return EXIT_FAILURE;
         }
     }
+    if (lines.empty()) {
+        return EXIT_FAILURE;
+    }
 
-    std::vector<size_t> numbers{};
+    std::vector<Number> numbers{};
     {
         std::istringstream iss(lines[0]);
         Number num;
@@ -136,44 +153,16 @@ int main(int argc, char* argv[])
         }
     }
 
-    {
-        Bingos bingos{toBingos(lines)};
-        bool isBingo{false};
-        for (auto& num : numbers) {
-            if (isBingo) {
-                break;
-            }
-            for (auto& bingo : bingos) {
-                Number score;
-                std::tie(isBingo, score) = bingo.set(num);
-                if (isBingo) {
-                    std::cout << score << std::endl;
-                    break;
-                }
-            }
-        }
+    Bingo bingo{0};
+    if (!toBingo(lines, bingo)) {
+        return EXIT_FAILURE;
     }
-    {
-        Bingos bingos{toBingos(lines)};
-        bool areAllBingos{false};
-        for (auto& num : numbers) {
-            if (areAllBingos) {
-                break;
-            }
-            for (auto& bingo : bingos) {
-                auto [isBingo, score] = bingo.set(num);
-                if (!isBingo) {
-                    continue;
-                }
-                areAllBingos =
-                    std::all_of(bingos.cbegin(), bingos.cend(), [](const auto& bingo) { return bingo.isBingo(); });
-                if (areAllBingos) {
-                    std::cout << score << std::endl;
-                    break;
-                }
-            }
-        }
+    const auto wins{bingo.play(numbers)};
+    if (wins.empty()) {
+        return EXIT_FAILURE;
     }
+    std::cout << wins.front().score << std::endl;
+    std::cout << wins.back().score << std::endl;
 
     return EXIT_SUCCESS;
 }
@@ -5,11 +5,17 @@
 #define _CRT_SECURE_NO_WARNINGS
 
 #include <algorithm>
+#include <cstdlib>
 #include <fstream>
+#include <functional>
 #include <iostream>
-#include <map>
+#include <iterator>
+#include <limits>
+#include <queue>
+#include <set>
 #include <sstream>
 #include <string>
+#include <tuple>
 #include <vector>
 
 #include <gsl/util>
@@ -29,60 +35,446 @@ static bool readFile(std::string fileName, std::vector<std::string>& lines)
     return true;
 }
 
-using Point = std::pair<size_t, size_t>;
-using Points = std::vector<Point>;
-using Lines = std::vector<std::pair<Point, Point> >;
-using PointMap = std::map<Point, size_t>;
+using Point = std::pair<int64_t, int64_t>;
+using Line = std::pair<Point, Point>;
+using Lines = std::vector<Line>;
 
-static void addPoints(PointMap& counts, Points& points)
+// Upper limit of cells for the dense counter grid (256 MB), larger bounds use the sweep-line
+constexpr size_t maxDenseCells{size_t{1} << 28};
+
+// Line segment as seen by a row sweep: covers [x0 + dx * (y - y0), x0 + dx * (y - y0) + width) in rows y0..y1
+struct Segment
+{
+    int64_t y0;
+    int64_t y1;
+    int64_t x0;
+    int64_t dx;
+    int64_t width;
+};
+
+inline static int64_t sign(int64_t v)
+{
+    return (v > 0) - (v < 0);
+}
+
+inline static bool isCounted(const Line& line, bool withDiags)
+{
+    return withDiags || line.first.first == line.second.first || line.first.second == line.second.second;
+}
+
+static size_t countPointsDense(const Lines& lines, bool withDiags, const Point& lo, const Point& hi)
+{
+    const auto w{static_cast<size_t>(hi.first - lo.first + 1)};
+    const auto h{static_cast<size_t>(hi.second - lo.second + 1)};
+    // Saturating counter per cell, a cell is counted once it reaches two
+    std::vector<uint8_t> grid(w * h, 0);
+    size_t count{0};
+    for (const auto& line : lines) {
+        if (!isCounted(line, withDiags)) {
+            continue;
+        }
+        const auto& [x1, y1] = line.first;
+        const auto& [x2, y2] = line.second;
+        const auto dx{sign(x2 - x1)};
+        const auto dy{sign(y2 - y1)};
+        const auto n{std::max(std::abs(x2 - x1), std::abs(y2 - y1)) + 1};
+        const auto step{dy * static_cast<int64_t>(w) + dx};
+        auto idx{(y1 - lo.second) * static_cast<int64_t>(w) + (x1 - lo.first)};
+        for (int64_t i = 0; i < n; ++i, idx += step) {
+            auto& c = grid[idx];
+            if (c < 2 && ++c == 2) {
+                ++count;
+            }
+        }
+    }
+    return count;
+}
+
+inline static int64_t key(const Segment& seg)
+{
+    return seg.x0 - seg.dx * seg.y0;
+}
+
+// Non-horizontal line x = key + dx * y, shared by all segments of the same key and direction, covered by count of them
+struct SweepLine
+{
+    int64_t key;
+    int64_t dx;
+    int count;
+};
+
+// Bentley-Ottmann sweep over the rows, the active lines are ordered by their column and only neighbours are checked for
+// crossings. Time runs at twice the row, t = 2 * y, such that rising and falling diagonals that swap between two rows
+// without a common point cross at an odd time. Between events every row has one point covered twice per line that is
+// covered by at least two segments, which are counted at once; rows with crossings, new lines or horizontal segments
+// are corrected by the lines at the points involved.
+class RowSweep
 {
-    for (const auto& point : points) {
-        auto p = counts.find(point);
-        if (p != counts.end()) {
-            ++p->second;
+public:
+    RowSweep(const std::vector<Segment>& segs, std::vector<Segment> horizontals)
+        : horizontals{std::move(horizontals)}, active{Order{this}}
+    {
+        for (const auto& seg : segs) {
+            lines.push_back({key(seg), seg.dx, 0});
+        }
+        const auto byLine = [](const auto& a, const auto& b) { return std::tie(a.dx, a.key) < std::tie(b.dx, b.key); };
+        std::sort(lines.begin(), lines.end(), byLine);
+        lines.erase(std::unique(lines.begin(), lines.end(),
+                                [](const auto& a, const auto& b) { return a.dx == b.dx && a.key == b.key; }),
+                    lines.end());
+        for (const auto& seg : segs) {
+            const auto line{static_cast<size_t>(
+                std::lower_bound(lines.cbegin(), lines.cend(), SweepLine{key(seg), seg.dx, 0}, byLine) -
+                lines.cbegin())};
+            starts.emplace_back(2 * seg.y0, line);
+            ends.emplace_back(2 * seg.y1 + 1, line);
+        }
+        std::sort(starts.begin(), starts.end());
+        std::sort(ends.begin(), ends.end());
+        std::sort(this->horizontals.begin(), this->horizontals.end(),
+                  [](const auto& a, const auto& b) { return std::tie(a.y0, a.x0) < std::tie(b.y0, b.x0); });
+        where.resize(lines.size());
+    }
+
+    RowSweep(const RowSweep&) = delete;
+    RowSweep& operator=(const RowSweep&) = delete;
+
+    size_t count()
+    {
+        int64_t total{0};
+        auto t{nextTime()};
+        if (t == never) {
+            return 0;
+        }
+        int64_t row{t / 2};
+        for (; t != never; t = nextTime()) {
+            time = t;
+            if (t > 2 * row) {
+                const auto rows{(t - 2 * row + 1) / 2};
+                total += static_cast<int64_t>(multiples) * rows;
+                row += rows;
+            }
+            if (t & 1) {
+                for (; nextEnd < ends.size() && ends[nextEnd].first == t; ++nextEnd) {
+                    remove(ends[nextEnd].second);
+                }
+                cross();
+            } else {
+                shared.clear();
+                cross();
+                for (; nextStart < starts.size() && starts[nextStart].first == t; ++nextStart) {
+                    insert(starts[nextStart].second);
+                }
+                total += static_cast<int64_t>(multiples) + correctShared() + correctHorizontals(row);
+                ++row;
+            }
+        }
+        return static_cast<size_t>(total);
+    }
+
+private:
+    static constexpr int64_t never{std::numeric_limits<int64_t>::max()};
+
+    // Doubled column of a line at the current time
+    struct Position
+    {
+        int64_t value;
+    };
+
+    // Place of a line in the column order, the lines through a crossing swap their slots in place
+    struct Slot
+    {
+        mutable size_t line;
+    };
+
+    // Lines by column, lines through the same point by direction as after their crossing
+    struct Order
+    {
+        using is_transparent = void;
+
+        const RowSweep* sweep;
+
+        bool operator()(const Slot& a, const Slot& b) const
+        {
+            const auto pa{sweep->position(a.line)};
+            const auto pb{sweep->position(b.line)};
+            return pa < pb || (pa == pb && sweep->lines[a.line].dx < sweep->lines[b.line].dx);
+        }
+
+        bool operator()(const Slot& a, Position p) const
+        {
+            return sweep->position(a.line) < p.value;
+        }
+
+        bool operator()(Position p, const Slot& a) const
+        {
+            return p.value < sweep->position(a.line);
+        }
+    };
+
+    using Active = std::set<Slot, Order>;
+
+    // Crossing of neighbours a and b at the given time, a is left of b before
+    struct Crossing
+    {
+        int64_t time;
+        size_t a;
+        size_t b;
+
+        bool operator>(const Crossing& other) const
+        {
+            return time > other.time;
+        }
+    };
+
+    int64_t position(size_t line) const
+    {
+        return 2 * lines[line].key + lines[line].dx * time;
+    }
+
+    int64_t nextTime() const
+    {
+        auto t{never};
+        if (nextStart < starts.size()) {
+            t = std::min(t, starts[nextStart].first);
+        }
+        if (nextEnd < ends.size()) {
+            t = std::min(t, ends[nextEnd].first);
+        }
+        if (nextHorizontal < horizontals.size()) {
+            t = std::min(t, 2 * horizontals[nextHorizontal].y0);
+        }
+        if (!crossings.empty()) {
+            t = std::min(t, crossings.top().time);
+        }
+        return t;
+    }
+
+    // Schedules the crossing of neighbours a and b, if a is left of b and they converge
+    void schedule(size_t a, size_t b)
+    {
+        if (lines[a].dx <= lines[b].dx) {
+            return;
+        }
+        crossings.push({2 * (lines[b].key - lines[a].key) / (lines[a].dx - lines[b].dx), a, b});
+    }
+
+    void insert(size_t line)
+    {
+        if (++lines[line].count == 2) {
+            ++multiples;
+        }
+        if (lines[line].count > 1) {
+            return;
+        }
+        const auto it{active.insert(Slot{line}).first};
+        where[line] = it;
+        if (it != active.begin()) {
+            neighbours(std::prev(it)->line, line);
+        }
+        if (const auto next{std::next(it)}; next != active.end()) {
+            neighbours(line, next->line);
+        }
+    }
+
+    // New neighbours at the current even time either meet in this row or cross later
+    void neighbours(size_t a, size_t b)
+    {
+        if (position(a) == position(b)) {
+            shared.push_back(a);
+        } else {
+            schedule(a, b);
+        }
+    }
+
+    void remove(size_t line)
+    {
+        if (--lines[line].count == 1) {
+            --multiples;
+        }
+        if (lines[line].count > 0) {
+            return;
+        }
+        const auto it{where[line]};
+        const auto next{std::next(it)};
+        if (it != active.begin() && next != active.end()) {
+            schedule(std::prev(it)->line, next->line);
+        }
+        active.erase(it);
+    }
+
+    // Reverses the lines through the points of the crossings at the current time, which keeps their slots ordered,
+    // stale crossings are skipped
+    void cross()
+    {
+        while (!crossings.empty() && crossings.top().time == time) {
+            const auto [t, a, b] = crossings.top();
+            crossings.pop();
+            if (lines[a].count == 0 || lines[b].count == 0 || std::next(where[a]) != where[b] ||
+                position(a) != position(b)) {
+                continue;
+            }
+            const auto p{position(a)};
+            auto first{where[a]};
+            while (first != active.begin() && position(std::prev(first)->line) == p) {
+                --first;
+            }
+            auto last{std::next(where[b])};
+            while (last != active.end() && position(last->line) == p) {
+                ++last;
+            }
+            group.clear();
+            for (auto it{first}; it != last; ++it) {
+                group.push_back(it->line);
+            }
+            auto line{group.crbegin()};
+            for (auto it{first}; it != last; ++it, ++line) {
+                it->line = *line;
+                where[*line] = it;
+            }
+            if (first != active.begin()) {
+                schedule(std::prev(first)->line, first->line);
+            }
+            if (last != active.end()) {
+                schedule(std::prev(last)->line, last->line);
+            }
+            if (!(time & 1)) {
+                shared.push_back(first->line);
+            }
+        }
+    }
+
+    // Points of several lines are covered twice once, instead of once per line covered by at least two segments
+    int64_t correctShared()
+    {
+        const auto byPosition = [this](const auto a, const auto b) { return position(a) < position(b); };
+        std::sort(shared.begin(), shared.end(), byPosition);
+        shared.erase(std::unique(shared.begin(), shared.end(),
+                                 [this](const auto a, const auto b) { return position(a) == position(b); }),
+                     shared.end());
+        int64_t correction{0};
+        for (const auto line : shared) {
+            const auto p{position(line)};
+            auto first{where[line]};
+            while (first != active.begin() && position(std::prev(first)->line) == p) {
+                --first;
+            }
+            int64_t n{0};
+            int64_t multi{0};
+            for (auto it{first}; it != active.end() && position(it->line) == p; ++it) {
+                ++n;
+                multi += lines[it->line].count > 1;
+            }
+            if (n > 1) {
+                correction += 1 - multi;
+            }
+        }
+        return correction;
+    }
+
+    // Points of the horizontal segments in the row, visiting only the lines that run through them
+    int64_t correctHorizontals(int64_t row)
+    {
+        edges.clear();
+        for (; nextHorizontal < horizontals.size() && horizontals[nextHorizontal].y0 == row; ++nextHorizontal) {
+            const auto& seg{horizontals[nextHorizontal]};
+            edges.emplace_back(seg.x0, 1);
+            edges.emplace_back(seg.x0 + seg.width, -1);
+        }
+        std::sort(edges.begin(), edges.end());
+        int64_t correction{0};
+        int depth{0};
+        for (size_t i = 0; i < edges.size(); ++i) {
+            depth += edges[i].second;
+            if (depth == 0 || edges[i + 1].first == edges[i].first) {
+                continue;
+            }
+            // Columns [x0, x1) are covered by depth horizontal segments
+            const auto x0{edges[i].first};
+            const auto x1{edges[i + 1].first};
+            if (depth > 1) {
+                correction += x1 - x0;
+            }
+            auto it{active.lower_bound(Position{2 * x0})};
+            while (it != active.end() && position(it->line) < 2 * x1) {
+                const auto p{position(it->line)};
+                int covered{0};
+                for (; it != active.end() && position(it->line) == p; ++it) {
+                    covered += lines[it->line].count;
+                }
+                if (depth > 1 && covered > 1) {
+                    --correction;
+                } else if (depth == 1 && covered == 1) {
+                    ++correction;
+                }
+            }
+        }
+        return correction;
+    }
+
+    std::vector<SweepLine> lines{};
+    std::vector<Segment> horizontals;
+    // Times at which a segment of a line starts or ends
+    std::vector<std::pair<int64_t, size_t> > starts{};
+    std::vector<std::pair<int64_t, size_t> > ends{};
+    size_t nextStart{0};
+    size_t nextEnd{0};
+    size_t nextHorizontal{0};
+    // Crossings of neighbours by time
+    std::priority_queue<Crossing, std::vector<Crossing>, std::greater<> > crossings{};
+    int64_t time{0};
+    Active active;
+    std::vector<Active::iterator> where{};
+    // Lines covered by at least two segments
+    size_t multiples{0};
+    // A line through each point of several lines in the current row
+    std::vector<size_t> shared{};
+    std::vector<size_t> group{};
+    std::vector<std::pair<int64_t, int> > edges{};
+};
+
+static size_t countPointsSweep(const Lines& lines, bool withDiags)
+{
+    std::vector<Segment> segs;
+    std::vector<Segment> horizontals;
+    for (const auto& line : lines) {
+        if (!isCounted(line, withDiags)) {
+            continue;
+        }
+        // Orient top to bottom
+        const auto& [p1, p2] = line.first.second <= line.second.second ? line : Line{line.second, line.first};
+        if (p1.second == p2.second) {
+            horizontals.push_back(
+                {p1.second, p1.second, std::min(p1.first, p2.first), 0, std::abs(p2.first - p1.first) + 1});
         } else {
-            counts.emplace(point, 1);
+            segs.push_back({p1.second, p2.second, p1.first, sign(p2.first - p1.first), 1});
         }
     }
+    return RowSweep{segs, std::move(horizontals)}.count();
 }
 
 static size_t countPoints(const Lines& lines, bool withDiags = false)
 {
-    PointMap counts;
+    Point lo{std::numeric_limits<int64_t>::max(), std::numeric_limits<int64_t>::max()};
+    Point hi{std::numeric_limits<int64_t>::min(), std::numeric_limits<int64_t>::min()};
     for (const auto& line : lines) {
-        const auto& x1 = line.first.first;
-        const auto& y1 = line.first.second;
-        const auto& x2 = line.second.first;
-        const auto& y2 = line.second.second;
-        Points points;
-        if (x1 == x2) {
-            const auto d = (y2 > y1) ? (y2 - y1) : (y1 - y2);
-            points.resize(d + 1);
-            std::generate(points.begin(), points.end(),
-                          [x = x1, y = std::min<size_t>(y1, y2)]() mutable { return Point(x, y++); });
-        } else if (y1 == y2) {
-            const auto d = (x2 > x1) ? (x2 - x1) : (x1 - x2);
-            points.resize(d + 1);
-            std::generate(points.begin(), points.end(),
-                          [x = std::min<size_t>(x1, x2), y = y1]() mutable { return Point(x++, y); });
-        } else if (withDiags) {
-            if (x2 > x1 && y2 > y1) {
-                points.resize(x2 - x1 + 1);
-                std::generate(points.begin(), points.end(), [x = x1, y = y1]() mutable { return Point(x++, y++); });
-            } else if (x2 > x1) {
-                points.resize(x2 - x1 + 1);
-                std::generate(points.begin(), points.end(), [x = x1, y = y1]() mutable { return Point(x++, y--); });
-            } else if (y2 > y1) {
-                points.resize(y2 - y1 + 1);
-                std::generate(points.begin(), points.end(), [x = x1, y = y1]() mutable { return Point(x--, y++); });
-            } else {
-                points.resize(y1 - y2 + 1);
-                std::generate(points.begin(), points.end(), [x = x1, y = y1]() mutable { return Point(x--, y--); });
-            }
+        if (!isCounted(line, withDiags)) {
+            continue;
+        }
+        for (const auto& [x, y] : {line.first, line.second}) {
+            lo = {std::min(lo.first, x), std::min(lo.second, y)};
+            hi = {std::max(hi.first, x), std::max(hi.second, y)};
         }
-        addPoints(counts, points);
     }
-    return std::count_if(counts.cbegin(), counts.cend(), [](const auto& c) { return c.second > 1; });
+    if (lo.first > hi.first) {
+        return 0;
+    }
+    const auto w{static_cast<uint64_t>(hi.first - lo.first) + 1};
+    const auto h{static_cast<uint64_t>(hi.second - lo.second) + 1};
+    if (w <= maxDenseCells / h) {
+        return countPointsDense(lines, withDiags, lo, hi);
+    }
+    return countPointsSweep(lines, withDiags);
 }
 
 int main(int argc, char* argv[])
@@ -96,8 +488,10 @@ int main(int argc, char* argv[])
 
     Lines segs;
     for (const auto& line : lines) {
-        size_t x1, y1, x2, y2;
-        std::sscanf(line.c_str(), "%u,%u -> %u,%u", &x1, &y1, &x2, &y2);
+        long long x1, y1, x2, y2;
+        if (std::sscanf(line.c_str(), "%lld,%lld -> %lld,%lld", &x1, &y1, &x2, &y2) != 4) {
+            continue;
+        }
         segs.push_back({{x1, y1}, {x2, y2}});
     }
 
@@ -2,6 +2,8 @@
 // Day 6: Lanternfish
 // https://adventofcode.com/2021/day/6
 
+#include "../matrix.h"
+
 #include <algorithm>
 #include <array>
 #include <fstream>
@@ -27,20 +29,33 @@ static bool readFile(std::string fileName, std::vector<std::string>& lines)
     return true;
 }
 
-static uint64_t count(const std::vector<uint16_t>& numbers, size_t end)
+// Additionally counts the fish after extremeDays modulo extremePrime
+constexpr bool extreme{false};
+constexpr uint64_t extremeDays{1000000000000};
+constexpr uint32_t extremePrime{1000000007};
+
+// Age histogram transition for one day: every timer counts down, fish at zero reset to 6 and spawn one at 8
+static Matrix<uint64_t, 9> dayMatrix()
 {
-    std::array<uint64_t, 9> d{};
-    for (const auto& num : numbers) {
-        ++d[num];
+    Matrix<uint64_t, 9> m{};
+    for (size_t i = 0; i < 8; ++i) {
+        m[i][i + 1] = 1;
     }
-    uint64_t len{numbers.size()};
-    for (size_t i = 0; i < end; ++i) {
-        auto z{d.front()};
-        std::rotate(d.begin(), d.begin() + 1, d.end());
-        d[6] += z;
-        len += z;
+    m[6][0] = 1;
+    m[8][0] = 1;
+    return m;
+}
+
+// Number of fish after the given days in O(log days), use Modular<P> for extreme day counts
+template <typename Arith = Wrapping>
+static uint64_t count(const std::vector<uint16_t>& numbers, uint64_t end)
+{
+    Vector<uint64_t, 9> d{};
+    for (const auto& num : numbers) {
+        d[num] = Arith::add(d[num], 1);
     }
-    return len;
+    d = power<Arith, 9>(dayMatrix(), d, end);
+    return std::accumulate(d.cbegin(), d.cend(), uint64_t{0}, Arith::add);
 }
 
 int main(int argc, char* argv[])
@@ -67,6 +82,9 @@ int main(int argc, char* argv[])
 
     std::cout << count(numbers, 80) << std::endl;
     std::cout << count(numbers, 256) << std::endl;
+    if (extreme) {
+        std::cout << count<Modular<extremePrime> >(numbers, extremeDays) << std::endl;
+    }
 
     return EXIT_SUCCESS;
 }
@@ -3,9 +3,10 @@
 // https://adventofcode.com/2021/day/7
 
 #include <algorithm>
+#include <cstdlib>
 #include <fstream>
 #include <iostream>
-#include <numeric>
+#include <limits>
 #include <sstream>
 #include <vector>
 
@@ -26,7 +27,64 @@ static bool readFile(std::string fileName, std::vector<std::string>& lines)
     return true;
 }
 
-using Number = long;
+using Number = int64_t;
+
+// Crab counts per position, shifted by the minimum position
+struct Histogram
+{
+    Number offset{0};
+    std::vector<size_t> counts{};
+    size_t total{0};
+};
+
+static Histogram toHistogram(const std::vector<Number>& numbers)
+{
+    const auto& [min, max] = std::minmax_element(numbers.cbegin(), numbers.cend());
+    Histogram h{*min, std::vector<size_t>(static_cast<size_t>(*max - *min) + 1, 0), numbers.size()};
+    for (const auto& num : numbers) {
+        ++h.counts[num - h.offset];
+    }
+    return h;
+}
+
+template <typename Cost>
+static Number fuel(const Histogram& h, Number pos, Cost cost)
+{
+    Number sum{0};
+    for (size_t i = 0; i < h.counts.size(); ++i) {
+        if (h.counts[i] > 0) {
+            sum += static_cast<Number>(h.counts[i]) * cost(std::abs(static_cast<Number>(i) + h.offset - pos));
+        }
+    }
+    return sum;
+}
+
+// Linear cost is minimized at the median
+static Number alignLinear(const Histogram& h)
+{
+    size_t seen{0};
+    size_t i{0};
+    while ((seen += h.counts[i]) * 2 < h.total) {
+        ++i;
+    }
+    return fuel(h, static_cast<Number>(i) + h.offset, [](Number n) { return n; });
+}
+
+// Triangular cost is convex with its minimum within 1/2 of the mean
+static Number alignTriangular(const Histogram& h)
+{
+    Number sum{0};
+    for (size_t i = 0; i < h.counts.size(); ++i) {
+        sum += static_cast<Number>(h.counts[i]) * static_cast<Number>(i);
+    }
+    const auto mean{sum / static_cast<Number>(h.total) + h.offset};
+    const auto triangular = [](Number n) { return n * (n + 1) / 2; };
+    Number min{std::numeric_limits<Number>::max()};
+    for (auto pos = mean - 1; pos <= mean + 1; ++pos) {
+        min = std::min(min, fuel(h, pos, triangular));
+    }
+    return min;
+}
 
 int main(int argc, char* argv[])
 {
@@ -49,30 +107,13 @@ int main(int argc, char* argv[])
             iss.ignore(1);
         }
     }
-
-    {  // Part 1
-        Number min{INT32_MAX};
-        for (const auto& num : numbers) {
-            std::vector<Number> s(numbers.size());
-            std::transform(numbers.begin(), numbers.end(), s.begin(), [&](auto& v) { return std::abs(v - num); });
-            const auto sum{std::accumulate(s.begin(), s.end(), 0, std::plus<Number>())};
-            min = std::min<Number>(min, sum);
-        }
-        std::cout << min << std::endl;
-    }
-    {  // Part 2
-        Number min{INT32_MAX};
-        for (Number num = 0; num < static_cast<Number>(numbers.size()); ++num) {
-            std::vector<Number> s(numbers.size());
-            std::transform(numbers.begin(), numbers.end(), s.begin(), [&](auto& v) {
-                const Number n{std::abs(v - num)};
-                return n * (n + 1) / 2;
-            });
-            const auto sum{std::accumulate(s.begin(), s.end(), 0, std::plus<Number>())};
-            min = std::min<Number>(min, sum);
-        }
-        std::cout << min << std::endl;
+    if (numbers.empty()) {
+        return EXIT_FAILURE;
     }
 
+    const auto h{toHistogram(numbers)};
+    std::cout << alignLinear(h) << std::endl;
+    std::cout << alignTriangular(h) << std::endl;
+
     return EXIT_SUCCESS;
 }
@@ -4,8 +4,10 @@
 
 #include <algorithm>
 #include <array>
+#include <cstdint>
 #include <fstream>
 #include <iostream>
+#include <numeric>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -28,68 +30,71 @@ static bool readFile(std::string fileName, std::vector<std::string>& lines)
 }
 
 constexpr size_t n = 4;
-using Code = std::string;
+using Code = uint8_t;  // Segment a to g as bit 0 to 6
 using ICodes = std::array<Code, 10>;
 using OCodes = std::array<Code, n>;
 using Puzzle = std::pair<ICodes, OCodes>;
 using Puzzles = std::vector<Puzzle>;
 
-static bool containsAllOf(const Code& s1, const Code& s2)
-{
-    return std::all_of(s1.cbegin(), s1.cend(), [&](const auto& c) { return s2.find(c) != Code::npos; });
-}
+// Segments of the digits 0 to 9 on an unscrambled display
+constexpr std::array<Code, 10> digitCodes{0b1110111, 0b0100100, 0b1011101, 0b1101101, 0b0101110,
+                                          0b1101011, 0b1111011, 0b0100101, 0b1111111, 0b1101111};
+
+constexpr std::array<uint8_t, 128> popCounts = [] {
+    std::array<uint8_t, 128> counts{};
+    for (size_t i = 1; i < counts.size(); ++i) {
+        counts[i] = counts[i / 2] + (i & 1);
+    }
+    return counts;
+}();
 
-static std::array<ICodes::iterator, 10> decode(ICodes& codes)
+// Segment count and overlaps with 1 and 4 are invariant under rewiring and unique per digit
+constexpr size_t key(Code code, Code one, Code four)
 {
-    std::array<ICodes::iterator, 10> s{};
-    // First the four unique ones: 1, 4, 7 and 8
-    s[1] = std::find_if(codes.begin(), codes.end(), [](const auto& c) { return c.size() == 2; });
-    s[7] = std::find_if(codes.begin(), codes.end(), [](const auto& c) { return c.size() == 3; });
-    s[4] = std::find_if(codes.begin(), codes.end(), [](const auto& c) { return c.size() == 4; });
-    s[8] = std::find_if(codes.begin(), codes.end(), [](const auto& c) { return c.size() == 7; });
-    // 6 is the only 6-segment number not containing all segments of 1
-    s[6] = std::find_if(codes.begin(), codes.end(),
-                        [&](const auto& c) { return c.size() == 6 && !containsAllOf(*s[1], c); });
-    // 3 is the only 5-segment number containing all the segments of 1
-    s[3] = std::find_if(codes.begin(), codes.end(),
-                        [&](const auto& c) { return c.size() == 5 && containsAllOf(*s[1], c); });
-    // 5 is the only 5-segment number where all segments are also in 6
-    s[5] = std::find_if(codes.begin(), codes.end(),
-                        [&](const auto& c) { return c.size() == 5 && containsAllOf(c, *s[6]); });
-    // 2 is the remaining 5-segment number
-    s[2] = std::find_if(codes.begin(), codes.end(),
-                        [&](const auto& c) { return c.size() == 5 && 0 != s[3]->compare(c) && 0 != s[5]->compare(c); });
-    // 9 is the only 6-segment number containing all the segments of 4
-    s[9] = std::find_if(codes.begin(), codes.end(),
-                        [&](const auto& c) { return c.size() == 6 && containsAllOf(*s[4], c); });
-    // 0 is the remaining 6-segment number
-    s[0] = std::find_if(codes.begin(), codes.end(),
-                        [&](const auto& c) { return c.size() == 6 && 0 != s[6]->compare(c) && 0 != s[9]->compare(c); });
+    return popCounts[code] * 15 + popCounts[code & one] * 5 + popCounts[code & four];
+}
 
-    // Sort the segments alphabetically
-    std::for_each(s.begin(), s.end(), [](auto& c) { std::sort(c->begin(), c->end()); });
+constexpr std::array<uint8_t, 7 * 15 + 2 * 5 + 4 + 1> digitByKey = [] {
+    std::array<uint8_t, 7 * 15 + 2 * 5 + 4 + 1> digits{};
+    for (auto& digit : digits) {
+        digit = UINT8_MAX;
+    }
+    for (uint8_t i = 0; i < 10; ++i) {
+        digits[key(digitCodes[i], digitCodes[1], digitCodes[4])] = i;
+    }
+    return digits;
+}();
 
-    return s;
+static Code toCode(const std::string& str)
+{
+    Code code{0};
+    for (const auto& c : str) {
+        code |= 1 << (c - 'a');
+    }
+    return code;
 }
 
-static size_t solve(Puzzle& puzzle)
+// Decodes the output values of many displays in one call
+static std::vector<uint16_t> decode(const Puzzles& puzzles)
 {
-    size_t num{0};
-    const auto& s{decode(puzzle.first)};
-
-    // Sort the segments alphabetically
-    auto& codes{puzzle.second};
-    std::for_each(codes.begin(), codes.end(), [](auto& c) { std::sort(c.begin(), c.end()); });
-
-    std::stringstream oss{};
-    for (const auto& code : codes) {
-        if (const auto& it{std::find_if(s.cbegin(), s.cend(), [&](const auto& c) { return 0 == c->compare(code); })};
-            it != s.cend()) {
-            oss << std::distance(s.cbegin(), it);
+    std::vector<uint16_t> values(puzzles.size());
+    std::transform(puzzles.cbegin(), puzzles.cend(), values.begin(), [](const auto& puzzle) {
+        Code one{0};
+        Code four{0};
+        for (const auto& code : puzzle.first) {
+            if (popCounts[code] == 2) {
+                one = code;
+            } else if (popCounts[code] == 4) {
+                four = code;
+            }
         }
-    }
-    oss >> num;
-    return num;
+        uint16_t value{0};
+        for (const auto& code : puzzle.second) {
+            value = value * 10 + digitByKey[key(code, one, four)];
+        }
+        return value;
+    });
+    return values;
 }
 
 int main(int argc, char* argv[])
@@ -102,17 +107,20 @@ int main(int argc, char* argv[])
     }
 
     Puzzles puzzles{};
+    puzzles.reserve(lines.size());
     for (const auto& line : lines) {
         std::istringstream iss(line);
         ICodes icodes{};
         OCodes ocodes{};
+        std::string c{};
         for (size_t i = 0; i < 10; ++i) {
-            iss >> icodes[i];
+            iss >> c;
+            icodes[i] = toCode(c);
         }
-        Code c{};
         iss >> c;
         for (size_t i = 0; i < n; ++i) {
-            iss >> ocodes[i];
+            iss >> c;
+            ocodes[i] = toCode(c);
         }
         puzzles.emplace_back(Puzzle(icodes, ocodes));
     }
@@ -122,17 +130,15 @@ int main(int argc, char* argv[])
         for (const auto& puzzle : puzzles) {
             const auto& codes = puzzle.second;
             sum += std::count_if(codes.cbegin(), codes.cend(), [](const auto& c) {
-                return c.size() == 2 || c.size() == 3 || c.size() == 4 || c.size() == 7;
+                const auto size{popCounts[c]};
+                return size == 2 || size == 3 || size == 4 || size == 7;
             });
         }
         std::cout << sum << std::endl;
     }
     {  // Part 2
-        size_t sum{0};
-        for (auto& puzzle : puzzles) {
-            sum += solve(puzzle);
-        }
-        std::cout << sum << std::endl;
+        const auto values{decode(puzzles)};
+        std::cout << std::accumulate(values.cbegin(), values.cend(), size_t{0}) << std::endl;
     }
 
     return EXIT_SUCCESS;
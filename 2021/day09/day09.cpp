@@ -3,9 +3,11 @@
 // https://adventofcode.com/2021/day/9
 
 #include <algorithm>
-#include <array>
+#include <cstdint>
+#include <functional>
 #include <fstream>
 #include <iostream>
+#include <numeric>
 #include <string>
 #include <vector>
 
@@ -32,20 +34,81 @@ using Point = std::pair<size_t, size_t>;
 using Points = std::vector<Point>;
 using Lines = std::vector<std::string>;
 
-static void findBasin(const Lines& map, Points& points)
+constexpr uint32_t noLabel{UINT32_MAX};
+
+struct Basins
+{
+    Points mins{};
+    std::vector<size_t> sizes{};
+};
+
+static uint32_t findRoot(std::vector<uint32_t>& parents, uint32_t label)
 {
-    const auto& [i, j] = points.back();
-    const auto& val{map[i][j]};
-    const std::array<Point, 4> adjs{{{i + 1, j}, {i - 1, j}, {i, j + 1}, {i, j - 1}}};
-    for (const auto& adj : adjs) {
-        if (std::find(points.cbegin(), points.cend(), adj) != points.cend()) {
-            continue;
+    while (parents[label] != label) {
+        label = parents[label] = parents[parents[label]];
+    }
+    return label;
+}
+
+// Two-pass connected-component labeling of the map padded by a border of nines, only two rows of labels are kept
+static Basins findBasins(const Lines& map)
+{
+    Basins basins{};
+    std::vector<uint32_t> parents{};
+    std::vector<size_t> sizes{};
+    const auto len{map[0].size()};
+    std::vector<uint32_t> prev(len, noLabel);
+    std::vector<uint32_t> cur(len, noLabel);
+    for (size_t i = 1; i < map.size() - 1; ++i) {
+        for (size_t j = 1; j < len - 1; ++j) {
+            const auto& val{map[i][j]};
+            if (val == nine) {
+                cur[j] = noLabel;
+                continue;
+            }
+            if (val < map[i + 1][j] && val < map[i - 1][j] && val < map[i][j + 1] && val < map[i][j - 1]) {
+                basins.mins.push_back({i, j});
+            }
+            const auto left{cur[j - 1]};
+            const auto up{prev[j]};
+            uint32_t label{};
+            if (left == noLabel && up == noLabel) {
+                label = static_cast<uint32_t>(parents.size());
+                parents.push_back(label);
+                sizes.push_back(0);
+            } else if (left == noLabel || up == noLabel) {
+                label = findRoot(parents, left == noLabel ? up : left);
+            } else {
+                label = findRoot(parents, left);
+                auto other{findRoot(parents, up)};
+                if (label != other) {
+                    if (sizes[label] < sizes[other]) {
+                        std::swap(label, other);
+                    }
+                    parents[other] = label;
+                    sizes[label] += sizes[other];
+                }
+            }
+            ++sizes[label];
+            cur[j] = label;
         }
-        if (val < map[adj.first][adj.second] && map[adj.first][adj.second] < nine) {
-            points.push_back(adj);
-            findBasin(map, points);
+        std::swap(prev, cur);
+    }
+    for (uint32_t label = 0; label < parents.size(); ++label) {
+        if (parents[label] == label) {
+            basins.sizes.push_back(sizes[label]);
         }
     }
+    return basins;
+}
+
+// The k largest sizes in descending order
+static std::vector<size_t> largest(std::vector<size_t> sizes, size_t k)
+{
+    k = std::min(k, sizes.size());
+    std::partial_sort(sizes.begin(), sizes.begin() + k, sizes.end(), std::greater{});
+    sizes.resize(k);
+    return sizes;
 }
 
 int main(int argc, char* argv[])
@@ -67,32 +130,17 @@ int main(int argc, char* argv[])
         map.emplace_back(border);
     }
     std::for_each(map.begin(), map.end(), [](auto& row) { row = nine + row + nine; });
-    Points mins{};
-    for (size_t i = 1; i < map.size() - 1; ++i) {
-        for (size_t j = 1; j < len + 1; ++j) {
-            const auto& val{map[i][j]};
-            if (val < map[i + 1][j] && val < map[i - 1][j] && val < map[i][j + 1] && val < map[i][j - 1]) {
-                mins.push_back({i, j});
-            }
-        }
-    }
-
+    const auto basins{findBasins(map)};
     {  //Part 1
-        size_t risk{mins.size()};
-        for (const auto& [i, j] : mins) {
+        size_t risk{basins.mins.size()};
+        for (const auto& [i, j] : basins.mins) {
             risk += map[i][j] - zero;
         }
         std::cout << risk << std::endl;
     }
     {  //Part 2
-        std::vector<size_t> sizes(mins.size());
-        std::transform(mins.begin(), mins.end(), sizes.begin(), [&](const auto& point) {
-            Points points{point};
-            findBasin(map, points);
-            return points.size();
-        });
-        std::nth_element(sizes.begin(), sizes.begin() + 2, sizes.end(), std::greater{});
-        size_t prod{sizes[0] * sizes[1] * sizes[2]};
+        const auto sizes{largest(basins.sizes, 3)};
+        const auto prod{std::accumulate(sizes.cbegin(), sizes.cend(), size_t{1}, std::multiplies<size_t>{})};
         std::cout << prod << std::endl;
     }
 
@@ -4,111 +4,143 @@
 
 #include <algorithm>
 #include <array>
+#include <cstdint>
 #include <fstream>
-#include <map>
 #include <iostream>
-#include <stack>
 #include <string>
 #include <vector>
 
 #include <gsl/util>
 
-static bool readFile(std::string fileName, std::vector<std::string>& map)
-{
-    std::ifstream in{fileName.c_str()};
-    if (!in) {
-        std::cerr << "Cannot open file " << fileName << std::endl;
-        return false;
+constexpr int8_t other{-1};
+constexpr int8_t closer{4};
+
+// Bracket class per byte: 0 to 3 for the openers, the same index plus closer for the closers and other else
+constexpr std::array<int8_t, 256> classes = [] {
+    std::array<int8_t, 256> table{};
+    for (auto& c : table) {
+        c = other;
     }
-    auto closeStream = gsl::finally([&in] { in.close(); });
-    std::string str;
-    while (std::getline(in, str)) {
-        map.push_back(str);
+    constexpr std::array<std::pair<uint8_t, uint8_t>, 4> brackets{{{'(', ')'}, {'[', ']'}, {'{', '}'}, {'<', '>'}}};
+    for (int8_t i = 0; i < 4; ++i) {
+        table[brackets[i].first] = i;
+        table[brackets[i].second] = i + closer;
     }
-    return true;
-}
+    return table;
+}();
 
-constexpr std::array<std::string::value_type, 4> openers{'(', '[', '{', '<'};
+constexpr std::array<uint64_t, 4> errorPenalty{3, 57, 1197, 25137};
+constexpr std::array<uint64_t, 4> completionPenalty{1, 2, 3, 4};
 
-static inline bool isOpener(const std::string::value_type& c)
+// Checks a bracket stream line by line in one pass, the input may be fed in arbitrary chunks, the opener stack grows
+// to the deepest line seen and is reused for all later lines
+class SyntaxChecker
 {
-    return std::any_of(openers.cbegin(), openers.cend(), [&](const auto& o) { return o == c; });
-}
+public:
+    SyntaxChecker()
+    {
+        stack.reserve(4096);
+    }
 
-static inline bool isValidClosener(const std::string::value_type& b, const std::string::value_type& c)
-{
-    return b == '(' && c == ')' || b == '[' && c == ']' || b == '{' && c == '}' || b == '<' && c == '>';
-}
+    void feed(const char* data, size_t size)
+    {
+        for (const auto* p = data; p != data + size; ++p) {
+            if (*p == '\n') {
+                endLine();
+                continue;
+            }
+            isEmpty = false;
+            if (isCorrupted) {
+                continue;
+            }
+            const auto c{classes[static_cast<uint8_t>(*p)]};
+            if (c == other) {
+                continue;
+            }
+            if (c < closer) {
+                stack.push_back(c);
+            } else if (stack.empty() || stack.back() != c - closer) {
+                isCorrupted = true;
+                err += errorPenalty[c - closer];
+            } else {
+                stack.pop_back();
+            }
+        }
+    }
 
-static std::stack<std::string::value_type> checkIncomplete(const std::string& line)
-{
-    std::stack<std::string::value_type> stack{};
-    for (const auto& c : line) {
-        if (isOpener(c)) {
-            stack.push(c);
-            continue;
+    // Completes a last line without line break
+    void finish()
+    {
+        if (!isEmpty) {
+            endLine();
         }
-        const auto& b{stack.top()};
-        stack.pop();
     }
-    return stack;
-}
 
-static uint64_t calcScore(const std::string& line, std::map<std::string::value_type, uint64_t>& penalty)
+    uint64_t getErrorScore() const
+    {
+        return err;
+    }
+
+    std::vector<uint64_t>& getCompletionScores()
+    {
+        return scores;
+    }
+
+private:
+    void endLine()
+    {
+        if (!isCorrupted) {
+            uint64_t score{0};
+            for (auto it = stack.crbegin(); it != stack.crend(); ++it) {
+                score = score * 5 + completionPenalty[*it];
+            }
+            scores.push_back(score);
+        }
+        stack.clear();
+        isEmpty = true;
+        isCorrupted = false;
+    }
+
+    std::vector<int8_t> stack{};
+    bool isEmpty{true};
+    bool isCorrupted{false};
+    uint64_t err{0};
+    std::vector<uint64_t> scores{};
+};
+
+static bool checkFile(const std::string& fileName, SyntaxChecker& checker)
 {
-    auto stack{checkIncomplete(line)};
-    uint64_t score{0};
-    while (!stack.empty()) {
-        const auto& c{stack.top()};
-        stack.pop();
-        score *= 5;
-        score += penalty[c];
+    std::ifstream in{fileName.c_str(), std::ios::binary};
+    if (!in) {
+        std::cerr << "Cannot open file " << fileName << std::endl;
+        return false;
+    }
+    auto closeStream = gsl::finally([&in] { in.close(); });
+    std::vector<char> buffer(size_t{1} << 20);
+    while (in.read(buffer.data(), buffer.size()) || in.gcount() > 0) {
+        checker.feed(buffer.data(), static_cast<size_t>(in.gcount()));
     }
-    return score;
+    checker.finish();
+    return true;
 }
 
 int main(int argc, char* argv[])
 {
-    std::vector<std::string> lines{};
+    SyntaxChecker checker{};
     if (argc == 2) {
-        if (!readFile(argv[1], lines)) {
+        if (!checkFile(argv[1], checker)) {
             return EXIT_FAILURE;
         }
     }
 
     {  // Part 1
-        uint64_t err{0};
-        std::map<std::string::value_type, uint64_t> penalty{{')', 3}, {']', 57}, {'}', 1197}, {'>', 25137}};
-        auto line{lines.begin()};
-        while (line != lines.end()) {
-            std::stack<std::string::value_type> stack{};
-            bool isValid{true};
-            for (const auto& c : *line) {
-                if (isOpener(c)) {
-                    stack.push(c);
-                    continue;
-                }
-                const auto& b{stack.top()};
-                stack.pop();
-                isValid = isValidClosener(b, c);
-                if (!isValid) {
-                    err += penalty[c];
-                    break;
-                }
-            }
-            if (isValid) {
-                ++line;
-            } else {
-                line = lines.erase(line);
-            }
-        }
-        std::cout << err << std::endl;
+        std::cout << checker.getErrorScore() << std::endl;
     }
     {  // Part 2
-        std::vector<uint64_t> scores(lines.size());
-        std::map<std::string::value_type, uint64_t> penalty{{'(', 1}, {'[', 2}, {'{', 3}, {'<', 4}};
-        std::transform(lines.begin(), lines.end(), scores.begin(),
-                       [&](const auto& line) { return calcScore(line, penalty); });
+        auto& scores{checker.getCompletionScores()};
+        if (scores.empty()) {
+            return EXIT_FAILURE;
+        }
         // Median
         std::nth_element(scores.begin(), scores.begin() + scores.size() / 2, scores.end());
         std::cout << scores[scores.size() / 2] << std::endl;
@@ -9,13 +9,13 @@
 #include <algorithm>
 #include <array>
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <fstream>
 #include <iostream>
-#include <queue>
 #include <random>
 #include <sstream>
 #include <string>
-#include <thread>
 #include <vector>
 
 #include <gsl/util>
@@ -35,76 +35,122 @@ static bool readFile(std::string fileName, std::vector<std::string>& map)
     return true;
 }
 
-constexpr size_t dim{10};
-using Point = std::pair<size_t, size_t>;
-using Row = std::array<uint16_t, dim + 2>;
-using Map = std::array<Row, dim + 2>;
+constexpr size_t dim{10};  // Size of a random map
+constexpr std::chrono::milliseconds frameTime{200};
 
-#if defined(_MSC_VER)
-static bool print(Map& map, size_t day, uint64_t count, const COORD& pos)
+// Energy levels on a map padded by a border of zeros, which are never incremented as they count as flashed
+class Octopuses
 {
-    std::cout << conmanip::setpos(pos.X, pos.Y) << conmanip::settextcolor(conmanip::console_text_colors::light_white)
-              << conmanip::setbgcolor(conmanip::console_bg_colors::black) << "Day: " << day << '\n'
-              << std::endl;
-    for (size_t i = 1; i < dim + 1; ++i) {
-        for (size_t j = 1; j < dim + 1; ++j) {
-            if (map[i][j] != 0) {
-                std::cout << conmanip::settextcolor(conmanip::console_text_colors::black) << map[i][j];
-            } else if (count < dim * dim) {
-                std::cout << conmanip::settextcolor(conmanip::console_text_colors::yellow) << map[i][j];
-            } else {
-                std::cout << conmanip::settextcolor(conmanip::console_text_colors::light_yellow) << map[i][j];
+public:
+    Octopuses(const std::vector<std::string>& lines)
+        : rows{lines.size()},
+          cols{lines[0].size()},
+          stride{cols + 2},
+          energy((rows + 2) * stride, 0),
+          adjs{{-1, 1, -static_cast<ptrdiff_t>(stride) - 1, -static_cast<ptrdiff_t>(stride),
+                -static_cast<ptrdiff_t>(stride) + 1, static_cast<ptrdiff_t>(stride) - 1,
+                static_cast<ptrdiff_t>(stride), static_cast<ptrdiff_t>(stride) + 1}}
+    {
+        for (size_t i = 0; i < rows; ++i) {
+            for (size_t j = 0; j < cols; ++j) {
+                energy[(i + 1) * stride + j + 1] = lines[i][j] - '0';
             }
         }
-        std::cout << '\n';
+        // Every octopus flashes at most once per step
+        flashing.reserve(rows * cols);
     }
 
-    std::chrono::duration<int, std::milli> timespan(200);
-    std::this_thread::sleep_for(timespan);
+    size_t size() const
+    {
+        return rows * cols;
+    }
 
-    return static_cast<bool>(GetAsyncKeyState(VK_ESCAPE));
-}
-#endif
+    size_t getRows() const
+    {
+        return rows;
+    }
 
-static uint64_t simulate(Map& map)
-{
-    uint64_t count{0};
-    std::queue<Point> q{};
-    for (size_t i = 1; i < dim + 1; ++i) {
-        for (size_t j = 1; j < dim + 1; ++j) {
-            if (++map[i][j] > 9) {
-                q.emplace(i, j);
-                map[i][j] = 0;
+    size_t getCols() const
+    {
+        return cols;
+    }
+
+    uint8_t get(size_t i, size_t j) const
+    {
+        return energy[(i + 1) * stride + j + 1];
+    }
+
+    // One step in O(cells + flashes), returns the number of flashes
+    uint64_t step()
+    {
+        for (size_t i = 1; i < rows + 1; ++i) {
+            for (auto idx = i * stride + 1; idx < i * stride + cols + 1; ++idx) {
+                if (++energy[idx] > 9) {
+                    energy[idx] = 0;
+                    flashing.push_back(idx);
+                }
             }
         }
-    }
 
-    while (!q.empty()) {
-        ++count;
-        const auto& f{q.front()};
-        q.pop();
-        size_t i{f.first};
-        size_t j{f.second};
-        const std::array<Point, 8> adjs{{{i + 1, j},
-                                         {i + 1, j + 1},
-                                         {i + 1, j - 1},
-                                         {i, j + 1},
-                                         {i, j - 1},
-                                         {i - 1, j},
-                                         {i - 1, j + 1},
-                                         {i - 1, j - 1}}};
-        for (const auto& adj : adjs) {
-            if (map[adj.first][adj.second] == 0) {
-                continue;
+        uint64_t count{0};
+        while (!flashing.empty()) {
+            ++count;
+            const auto idx{flashing.back()};
+            flashing.pop_back();
+            for (const auto& adj : adjs) {
+                auto& e = energy[idx + adj];
+                if (e == 0) {
+                    continue;
+                }
+                if (++e > 9) {
+                    e = 0;
+                    flashing.push_back(idx + adj);
+                }
             }
-            if (++map[adj.first][adj.second] > 9) {
-                q.emplace(adj.first, adj.second);
-                map[adj.first][adj.second] = 0;
+        }
+        return count;
+    }
+
+private:
+    size_t rows;
+    size_t cols;
+    size_t stride;
+    std::vector<uint8_t> energy;
+    std::array<ptrdiff_t, 8> adjs;
+    std::vector<size_t> flashing{};
+};
+
+#if defined(_MSC_VER)
+// Prints at most one frame per frame time and never waits, thus the simulation is not slowed down
+static bool print(const Octopuses& octopuses, size_t day, uint64_t count, const COORD& pos, bool force = false)
+{
+    static auto last{std::chrono::steady_clock::now() - frameTime};
+    const auto now{std::chrono::steady_clock::now()};
+    if (!force && now - last < frameTime) {
+        return false;
+    }
+    last = now;
+
+    std::cout << conmanip::setpos(pos.X, pos.Y) << conmanip::settextcolor(conmanip::console_text_colors::light_white)
+              << conmanip::setbgcolor(conmanip::console_bg_colors::black) << "Day: " << day << '\n'
+              << std::endl;
+    for (size_t i = 0; i < octopuses.getRows(); ++i) {
+        for (size_t j = 0; j < octopuses.getCols(); ++j) {
+            const auto e{static_cast<uint16_t>(octopuses.get(i, j))};
+            if (e != 0) {
+                std::cout << conmanip::settextcolor(conmanip::console_text_colors::black) << e;
+            } else if (count < octopuses.size()) {
+                std::cout << conmanip::settextcolor(conmanip::console_text_colors::yellow) << e;
+            } else {
+                std::cout << conmanip::settextcolor(conmanip::console_text_colors::light_yellow) << e;
             }
         }
+        std::cout << '\n';
     }
-    return count;
+
+    return static_cast<bool>(GetAsyncKeyState(VK_ESCAPE));
 }
+#endif
 
 int main(int argc, char* argv[])
 {
@@ -125,17 +171,12 @@ int main(int argc, char* argv[])
             return EXIT_FAILURE;
         }
     }
-    if (lines.size() != dim ||
-        std::any_of(lines.cbegin(), lines.cend(), [](const auto& line) { return line.size() != dim; })) {
+    if (lines.empty() || lines[0].empty() ||
+        std::any_of(lines.cbegin(), lines.cend(), [&](const auto& line) { return line.size() != lines[0].size(); })) {
         return EXIT_FAILURE;
     }
 
-    Map map{};
-    for (size_t i = 0; i < dim; ++i) {
-        for (size_t j = 0; j < dim; ++j) {
-            map[i + 1][j + 1] = lines[i][j] - '0';
-        }
-    }
+    Octopuses octopuses{lines};
 
 #if defined(_MSC_VER)
     conmanip::console_out_context ctxout;
@@ -148,14 +189,14 @@ int main(int argc, char* argv[])
     bool isEscape{false};
     {  // Part 1
         for (size_t day = 0; day < 100; ++day) {
-            const auto count{simulate(map)};
+            const auto count{octopuses.step()};
             total += count;
-            if (firstDay == 0 && count == dim * dim) {
+            if (firstDay == 0 && count == octopuses.size()) {
                 // Early case for part 2
                 firstDay = day + 1;
             }
 #if defined(_MSC_VER)
-            isEscape = print(map, day, count, conPos);
+            isEscape = print(octopuses, day, count, conPos, day == 99);
             if (isEscape) {
                 break;
             }
@@ -168,12 +209,12 @@ int main(int argc, char* argv[])
             size_t day{100};
             do {
                 ++day;
-                count = simulate(map);
-                if (count == dim * dim) {
+                count = octopuses.step();
+                if (count == octopuses.size()) {
                     firstDay = day;
                 }
 #if defined(_MSC_VER)
-                isEscape = print(map, day, count, conPos);
+                isEscape = print(octopuses, day, count, conPos, firstDay != 0);
 #endif
             } while (firstDay == 0 && !isEscape);
         }
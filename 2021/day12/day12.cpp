@@ -4,9 +4,9 @@
 
 #include <algorithm>
 #include <cctype>
+#include <cstdint>
 #include <fstream>
 #include <iostream>
-#include <queue>
 #include <regex>
 #include <sstream>
 #include <string>
@@ -29,131 +29,92 @@ static bool readFile(std::string fileName, std::vector<std::string>& lines)
     return true;
 }
 
-template <typename T>
-struct Node;
-
-template <typename T>
-using NodeRef = std::weak_ptr<Node<T> >;
-
-template <typename T>
-struct Node
+// Caves by id, small caves other than start and end additionally carry a bit index for the visited mask, since start
+// is never re-entered and end finishes the path
+struct CaveSystem
 {
-    T value{};
-    std::vector<NodeRef<T> > adjs{};
-    Node(const T& value) : value{value}
-    {
-    }
-};
+    std::vector<std::string> names{};
+    std::vector<std::vector<uint32_t> > adjs{};
+    std::vector<int> bits{};
+    size_t smallCount{0};
 
-template <typename T>
-struct Graph
-{
-    std::vector<std::shared_ptr<Node<T> > > nodes{};
-    NodeRef<T> get(const T& i) const
+    uint32_t get(const std::string& name)
     {
-        auto ret = NodeRef<T>{};
-        auto node{std::find_if(nodes.cbegin(), nodes.cend(), [&](const auto node) { return node.get()->value == i; })};
-        if (node == nodes.cend()) {
-            return ret;
+        auto it{std::find(names.cbegin(), names.cend(), name)};
+        if (it != names.cend()) {
+            return static_cast<uint32_t>(std::distance(names.cbegin(), it));
         }
-        ret = *node;
-        return ret;
+        names.push_back(name);
+        adjs.emplace_back();
+        const auto isSmall{std::islower(name[0]) && name != "start" && name != "end"};
+        bits.push_back(isSmall ? static_cast<int>(smallCount++) : -1);
+        return static_cast<uint32_t>(names.size() - 1);
     }
 
-    void addEdge(const T& i, const T& j)
+    void addEdge(const std::string& a, const std::string& b)
     {
-        auto nodeI = get(i);
-        if (nodeI.expired()) {
-            nodeI = nodes.emplace_back(std::make_shared<Node<T> >(i));
-        }
-        auto nodeJ = get(j);
-        if (nodeJ.expired()) {
-            nodeJ = nodes.emplace_back(std::make_shared<Node<T> >(j));
-        }
-        nodeI.lock()->adjs.emplace_back(nodeJ);
+        const auto i{get(a)};
+        const auto j{get(b)};
+        adjs[i].push_back(j);
+        adjs[j].push_back(i);
     }
 };
 
-using Path = std::vector<NodeRef<std::string> >;
-using VisitorFunc = bool(const NodeRef<std::string>, const Path&);
-
-static void printPath(const Path& path)
-{
-    for (size_t i = 0; i < path.size() - 1; ++i) {
-        std::cout << path[i].lock()->value << ",";
-    }
-    std::cout << path.back().lock()->value << std::endl;
-}
-
-static bool isVisited(const NodeRef<std::string> node, const Path& path)
-{
-    return std::find_if(path.cbegin(), path.cend(), [&](const auto& pathNode) {
-               return pathNode.lock()->value == node.lock()->value;
-           }) != path.cend();
-}
-
-static bool isVisited1(const NodeRef<std::string> node, const Path& path)
-{
-    if (std::isupper(node.lock()->value[0])) {
-        return false;
-    }
-    return isVisited(node, path);
-}
+constexpr uint64_t unknown{UINT64_MAX};
+// Upper limit of memo entries (512 MB)
+constexpr size_t maxMemoEntries{size_t{1} << 26};
 
-static bool isVisited2(const NodeRef<std::string> node, const Path& path)
+// Counts paths without materializing them, memoized per (cave, visited small caves, revisit used)
+class PathCounter
 {
-    if (std::isupper(node.lock()->value[0])) {
-        return false;
-    }
-    if (!isVisited(node, path)) {
-        return false;
-    }
-    if (node.lock()->value == "start") {
-        return true;
-    }
-    if (node.lock()->value == "end") {
-        return true;
+public:
+    PathCounter(const CaveSystem& caves) : caves{caves}
+    {
+        start = std::distance(caves.names.cbegin(), std::find(caves.names.cbegin(), caves.names.cend(), "start"));
+        end = std::distance(caves.names.cbegin(), std::find(caves.names.cbegin(), caves.names.cend(), "end"));
     }
 
-    Path sortedPath(path);
-    sortedPath.erase(std::remove_if(sortedPath.begin(), sortedPath.end(),
-                                    [](const auto& pathNode) { return std::isupper(pathNode.lock()->value[0]); }),
-                     sortedPath.end());
-    std::sort(sortedPath.begin(), sortedPath.end(),
-              [](const auto& a, const auto& b) { return a.lock()->value.compare(b.lock()->value) > 0; });
-
-    for (size_t i = 0; i < sortedPath.size() - 1; ++i) {
-        if (sortedPath[i].lock()->value == sortedPath[i + 1].lock()->value) {
-            return true;
+    uint64_t count(bool allowRevisit)
+    {
+        if (start >= caves.names.size() || end >= caves.names.size()) {
+            return 0;
         }
+        memo.assign(caves.names.size() << (caves.smallCount + 1), unknown);
+        return count(static_cast<uint32_t>(start), 0, !allowRevisit);
     }
-    return false;
-}
 
-static uint64_t countPathsBFS(NodeRef<std::string> start, NodeRef<std::string> end, VisitorFunc isVisited)
-{
-    uint64_t count{0};
-    std::queue<Path> q{};
-    Path path;
-    path.push_back(start);
-    q.push(path);
-    while (!q.empty()) {
-        path = q.front();
-        q.pop();
-        auto last{path.back()};
-        if (last.lock()->value == end.lock()->value) {
-            ++count;
+private:
+    uint64_t count(uint32_t cave, uint64_t visited, bool revisited)
+    {
+        if (cave == end) {
+            return 1;
+        }
+        auto& paths = memo[(((static_cast<size_t>(cave) << caves.smallCount) | visited) << 1) | revisited];
+        if (paths != unknown) {
+            return paths;
         }
-        for (auto adj : last.lock()->adjs) {
-            if (!isVisited(adj, path)) {
-                Path newPath(path);
-                newPath.push_back(adj);
-                q.push(newPath);
+        paths = 0;
+        for (const auto& adj : caves.adjs[cave]) {
+            if (adj == start) {
+                continue;
+            }
+            const auto bit{caves.bits[adj]};
+            if (bit < 0) {
+                paths += count(adj, visited, revisited);
+            } else if (!(visited & (uint64_t{1} << bit))) {
+                paths += count(adj, visited | (uint64_t{1} << bit), revisited);
+            } else if (!revisited) {
+                paths += count(adj, visited, true);
             }
         }
+        return paths;
     }
-    return count;
-}
+
+    const CaveSystem& caves;
+    size_t start{0};
+    size_t end{0};
+    std::vector<uint64_t> memo{};
+};
 
 int main(int argc, char* argv[])
 {
@@ -164,24 +125,25 @@ int main(int argc, char* argv[])
         }
     }
 
-    Graph<std::string> g{};
+    CaveSystem caves{};
     {
         std::regex reg("-");
         for (auto line : lines) {
             std::sregex_token_iterator begin(line.begin(), line.end(), reg, -1);
             std::sregex_token_iterator end{};
             std::vector<std::string> nodes(begin, end);
-            g.addEdge(nodes[0], nodes[1]);
-            if (nodes[0] != "start" && nodes[1] != "end") {
-                g.addEdge(nodes[1], nodes[0]);
-            }
+            caves.addEdge(nodes[0], nodes[1]);
         }
     }
+    if (caves.smallCount > 32 || caves.names.size() << (caves.smallCount + 1) > maxMemoEntries) {
+        std::cerr << "Too many caves for the memo table: " << caves.names.size() << " caves, " << caves.smallCount
+                  << " small ones" << std::endl;
+        return EXIT_FAILURE;
+    }
 
-    auto start{g.get("start")};
-    auto end{g.get("end")};
-    std::cout << countPathsBFS(start, end, isVisited1) << std::endl;
-    std::cout << countPathsBFS(start, end, isVisited2) << std::endl;
+    PathCounter counter{caves};
+    std::cout << counter.count(false) << std::endl;
+    std::cout << counter.count(true) << std::endl;
 
     return EXIT_SUCCESS;
 }
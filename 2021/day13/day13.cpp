@@ -5,8 +5,8 @@
 #include <algorithm>
 #include <fstream>
 #include <iostream>
+#include <numeric>
 #include <regex>
-#include <set>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -70,34 +70,75 @@ static std::tuple<Coords, Coords> get(const std::vector<std::string>& lines)
     return {coords, instrs};
 }
 
-static void fold(Coords& coords, const Coord& instr)
+using Mapping = std::vector<long>;
+
+// All folds along one axis composed into a lookup table from original to folded coordinate
+static Mapping compose(long max, const Coords& instrs, bool alongX)
 {
-    if (instr.first > 0) {
-        std::for_each(coords.begin(), coords.end(), [&](auto& coord) {
-            if (auto dx{coord.first - instr.first}; dx > 0) {
-                coord.first = instr.first - dx;
-            }
-        });
-    } else if (instr.second > 0) {
-        std::for_each(coords.begin(), coords.end(), [&](auto& coord) {
-            if (auto dy{coord.second - instr.second}; dy > 0) {
-                coord.second = instr.second - dy;
+    Mapping mapping(max + 1);
+    std::iota(mapping.begin(), mapping.end(), 0L);
+    for (const auto& instr : instrs) {
+        const auto line{alongX ? instr.first : instr.second};
+        if (line <= 0) {
+            continue;
+        }
+        std::for_each(mapping.begin(), mapping.end(), [line](auto& c) {
+            if (auto d{c - line}; d > 0) {
+                c = line - d;
             }
         });
     }
+    return mapping;
+}
+
+// Folded dots deduplicated into a bit canvas
+struct Canvas
+{
+    Coord min{};
+    Coord max{};
+    long width{0};
+    std::vector<bool> dots{};
+    size_t count{0};
+};
+
+static Canvas fold(const Coords& coords, const Coords& instrs)
+{
+    Canvas canvas{};
+    if (coords.empty()) {
+        return canvas;
+    }
+    const auto mapX{compose(std::max_element(coords.cbegin(), coords.cend(),
+                                             [](const auto& a, const auto& b) { return a.first < b.first; })
+                                ->first,
+                            instrs, true)};
+    const auto mapY{compose(std::max_element(coords.cbegin(), coords.cend(),
+                                             [](const auto& a, const auto& b) { return a.second < b.second; })
+                                ->second,
+                            instrs, false)};
+    const auto& [minX, maxX] = std::minmax_element(mapX.cbegin(), mapX.cend());
+    const auto& [minY, maxY] = std::minmax_element(mapY.cbegin(), mapY.cend());
+    canvas.min = {*minX, *minY};
+    canvas.max = {*minX, *minY};
+    canvas.width = *maxX - *minX + 1;
+    canvas.dots.resize(canvas.width * (*maxY - *minY + 1));
+    for (const auto& [x, y] : coords) {
+        const Coord c{mapX[x], mapY[y]};
+        auto dot = canvas.dots[(c.second - canvas.min.second) * canvas.width + c.first - canvas.min.first];
+        if (!dot) {
+            dot = true;
+            ++canvas.count;
+            canvas.max = {std::max(canvas.max.first, c.first), std::max(canvas.max.second, c.second)};
+        }
+    }
+    return canvas;
 }
 
-static void print(const std::set<Coord>& coords)
+static void print(const Canvas& canvas)
 {
-    auto dimx{std::max_element(coords.cbegin(), coords.cend(), [](const auto& a, const auto& b) {
-                  return a.first < b.first;
-              })->first};
-    auto dimy{std::max_element(coords.cbegin(), coords.cend(), [](const auto& a, const auto& b) {
-                  return a.second < b.second;
-              })->second};
-    for (long y = 0; y <= dimy; ++y) {
-        for (long x = 0; x <= dimx; ++x) {
-            if (coords.find({x, y}) != coords.end()) {
+    // Folding never moves a dot across the origin, thus min is at most zero
+    for (long y = 0; y <= canvas.max.second; ++y) {
+        for (long x = 0; x <= canvas.max.first; ++x) {
+            if (canvas.dots[(y - canvas.min.second) * canvas.width + x - canvas.min.first]) {
                 std::cout << "#";
             } else {
                 std::cout << " ";
@@ -116,17 +157,13 @@ int main(int argc, char* argv[])
         }
     }
 
-    auto [coords, instrs] = get(lines);
+    const auto [coords, instrs] = get(lines);
 
     {  // Part 1
-        fold(coords, instrs[0]);
-        std::set<Coord> folded(coords.cbegin(), coords.cend());
-        std::cout << folded.size() << std::endl;
+        std::cout << fold(coords, Coords{instrs[0]}).count << std::endl;
     }
     {  // Part 2
-        std::for_each(instrs.cbegin(), instrs.cend(), [&](const auto& instr) { fold(coords, instr); });
-        std::set<Coord> folded(coords.cbegin(), coords.cend());
-        print(folded);
+        print(fold(coords, instrs));
     }
 
     return EXIT_SUCCESS;
@@ -2,10 +2,15 @@
 // Day 14: Extended Polymerization
 // https://adventofcode.com/2021/day/14
 
+#include "../matrix.h"
+
 #include <algorithm>
+#include <cmath>
 #include <fstream>
 #include <iostream>
+#include <memory>
 #include <string>
+#include <type_traits>
 #include <unordered_map>
 #include <vector>
 
@@ -26,18 +31,113 @@ static bool readFile(std::string fileName, std::vector<std::string>& lines)
     return true;
 }
 
-static void increment(std::unordered_map<std::string::value_type, uint64_t>& d,
-                      std::unordered_map<std::string, uint64_t>& pairs,
-                      std::unordered_map<std::string, std::string>& map)
+// Additionally computes the spread after extremeSteps modulo extremePrime
+constexpr bool extreme{false};
+constexpr uint64_t extremeSteps{1000000000000};
+constexpr uint32_t extremePrime{1000000007};
+
+constexpr size_t maxElements{10};
+constexpr size_t maxPairs{maxElements * maxElements};
+
+using Rules = std::unordered_map<std::string, std::string>;
+
+// Element counts after the given steps in O(log steps), pair (a, b) is indexed by a * maxElements + b
+template <typename Arith>
+static Vector<typename Arith::value_type, maxElements> countElements(const std::string& elements, const Rules& rules,
+                                                                     const std::string& start, uint64_t steps)
+{
+    using T = typename Arith::value_type;
+    auto m{std::make_unique<Matrix<T, maxPairs> >()};
+    for (size_t a = 0; a < elements.size(); ++a) {
+        for (size_t b = 0; b < elements.size(); ++b) {
+            const auto from{a * maxElements + b};
+            const auto rule{rules.find(std::string{elements[a], elements[b]})};
+            if (rule == rules.cend()) {
+                (*m)[from][from] = 1;
+                continue;
+            }
+            const auto c{elements.find(rule->second[0])};
+            (*m)[a * maxElements + c][from] += 1;
+            (*m)[c * maxElements + b][from] += 1;
+        }
+    }
+    Vector<T, maxPairs> pairs{};
+    for (size_t i = 0; i < start.size() - 1; ++i) {
+        auto& p = pairs[elements.find(start[i]) * maxElements + elements.find(start[i + 1])];
+        p = Arith::add(p, 1);
+    }
+    pairs = power<Arith, maxPairs>(*m, pairs, steps);
+
+    // Every element but the last one is the first of exactly one pair
+    Vector<T, maxElements> d{};
+    for (size_t a = 0; a < elements.size(); ++a) {
+        for (size_t b = 0; b < elements.size(); ++b) {
+            d[a] = Arith::add(d[a], pairs[a * maxElements + b]);
+        }
+    }
+    // The rescaled floating counts have lost their unit, the last element is left to findMinMaxRescaled there
+    if constexpr (!std::is_floating_point_v<T>) {
+        auto& last = d[elements.find(start.back())];
+        last = Arith::add(last, 1);
+    }
+    return d;
+}
+
+// Indices of the least and most common element, ignoring elements that do not occur
+template <typename T>
+static std::pair<size_t, size_t> findMinMax(const Vector<T, maxElements>& d, size_t n)
+{
+    std::vector<size_t> present{};
+    for (size_t i = 0; i < n; ++i) {
+        if (d[i] > 0) {
+            present.push_back(i);
+        }
+    }
+    const auto& [min, max] = std::minmax_element(present.cbegin(), present.cend(),
+                                                 [&d](const auto& a, const auto& b) { return d[a] < d[b]; });
+    return {*min, *max};
+}
+
+// Same for rescaled counts without the last element, which occurs once more than counted: it only decides between
+// counts that are equal up to rounding, or if it does not occur elsewhere; counts closer than the double precision
+// cannot be told apart
+static std::pair<size_t, size_t> findMinMaxRescaled(const Vector<double, maxElements>& d, size_t n, size_t last)
 {
-    std::unordered_map<std::string, uint64_t> newPairs{};
-    for (const auto& [pair, count] : pairs) {
-        auto& ins = map[pair];
-        d[ins[0]] += count;
-        newPairs[pair[0] + ins] += count;
-        newPairs[ins + pair[1]] += count;
+    std::vector<size_t> present{};
+    for (size_t i = 0; i < n; ++i) {
+        if (d[i] > 0 || i == last) {
+            present.push_back(i);
+        }
     }
-    pairs.swap(newPairs);
+    const auto less = [&d, last](const auto& a, const auto& b) {
+        if (std::abs(d[a] - d[b]) > 1e-12 * std::max(d[a], d[b])) {
+            return d[a] < d[b];
+        }
+        return a != last && b == last;
+    };
+    const auto& [min, max] = std::minmax_element(present.cbegin(), present.cend(), less);
+    return {*min, *max};
+}
+
+static uint64_t spread(const std::string& elements, const Rules& rules, const std::string& start, uint64_t steps)
+{
+    const auto d{countElements<Wrapping>(elements, rules, start, steps)};
+    const auto [min, max] = findMinMax(d, elements.size());
+    return d[max] - d[min];
+}
+
+// Spread modulo P for extreme step counts, the least and most common element are selected by rescaled counts
+template <uint32_t P>
+static uint64_t spreadModulo(const std::string& elements, const Rules& rules, const std::string& start,
+                             uint64_t steps)
+{
+    // The polymer grows to at most start.size() * 2^steps elements, which select exactly while they fit into 64 bits
+    const auto [min, max] = steps < 64 && start.size() <= (UINT64_MAX >> steps)
+                                ? findMinMax(countElements<Wrapping>(elements, rules, start, steps), elements.size())
+                                : findMinMaxRescaled(countElements<Floating>(elements, rules, start, steps),
+                                                     elements.size(), elements.find(start.back()));
+    const auto d{countElements<Modular<P> >(elements, rules, start, steps)};
+    return (d[max] + P - d[min]) % P;
 }
 
 int main(int argc, char* argv[])
@@ -54,39 +154,27 @@ int main(int argc, char* argv[])
         return EXIT_FAILURE;
     }
 
-    std::unordered_map<std::string, std::string> map{};
+    Rules rules{};
+    std::string elements{lines[0]};
     for (size_t i = 2; i < lines.size(); ++i) {
         auto src{lines[i].substr(0, 2)};
         auto dst{lines[i].substr(6, 1)};
-        map.insert_or_assign(src, dst);
+        elements += src + dst;
+        rules.insert_or_assign(src, dst);
     }
-
-    const std::string start{lines[0]};
-    std::unordered_map<std::string, uint64_t> pairs{};
-    for (size_t i = 0; i < start.size() - 1; ++i) {
-        ++pairs[start.substr(i, 2)];
-    }
-
-    std::unordered_map<std::string::value_type, uint64_t> d{};
-    for (size_t i = 0; i < start.size(); ++i) {
-        ++d[start[i]];
+    std::sort(elements.begin(), elements.end());
+    elements.erase(std::unique(elements.begin(), elements.end()), elements.end());
+    if (elements.size() > maxElements) {
+        std::cerr << "Too many elements " << elements.size() << ", at most " << maxElements << " are supported"
+                  << std::endl;
+        return EXIT_FAILURE;
     }
 
-    {  // Part 1
-        for (size_t i = 0; i < 10; ++i) {
-            increment(d, pairs, map);
-        }
-        const auto& [min, max] =
-            std::minmax_element(d.cbegin(), d.cend(), [](const auto& a, const auto& b) { return a.second < b.second; });
-        std::cout << max->second - min->second << std::endl;
-    }
-    {  // Part 2
-        for (size_t i = 10; i < 40; ++i) {
-            increment(d, pairs, map);
-        }
-        const auto& [min, max] =
-            std::minmax_element(d.cbegin(), d.cend(), [](const auto& a, const auto& b) { return a.second < b.second; });
-        std::cout << max->second - min->second << std::endl;
+    const std::string start{lines[0]};
+    std::cout << spread(elements, rules, start, 10) << std::endl;
+    std::cout << spread(elements, rules, start, 40) << std::endl;
+    if (extreme) {
+        std::cout << spreadModulo<extremePrime>(elements, rules, start, extremeSteps) << std::endl;
     }
 
     return EXIT_SUCCESS;
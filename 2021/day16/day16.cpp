@@ -5,11 +5,10 @@
 #include "node.h"
 
 #include <algorithm>
-#include <cctype>
+#include <array>
+#include <cstdint>
 #include <fstream>
 #include <iostream>
-#include <numeric>
-#include <sstream>
 #include <string>
 #include <vector>
 
@@ -30,52 +29,54 @@ static bool readFile(std::string fileName, std::vector<std::string>& lines)
     return true;
 }
 
-static std::string word2Bin(std::string::value_type c)
+constexpr bool printTree{false};
+
+// Reads bit fields of up to 32 bits from a hex string through a 64-bit buffer, bits past the end read as zero
+class BitReader
 {
-    switch (std::toupper(c)) {
-        case '0':
-            return "0000";
-        case '1':
-            return "0001";
-        case '2':
-            return "0010";
-        case '3':
-            return "0011";
-        case '4':
-            return "0100";
-        case '5':
-            return "0101";
-        case '6':
-            return "0110";
-        case '7':
-            return "0111";
-        case '8':
-            return "1000";
-        case '9':
-            return "1001";
-        case 'A':
-            return "1010";
-        case 'B':
-            return "1011";
-        case 'C':
-            return "1100";
-        case 'D':
-            return "1101";
-        case 'E':
-            return "1110";
-        case 'F':
-            return "1111";
+public:
+    BitReader(const std::string& hex) : hex{hex}
+    {
     }
-    return "";
-}
 
-static std::string hex2Bin(const std::string& hex)
-{
-    std::stringstream bin{};
-    std::transform(hex.cbegin(), hex.cend(), std::ostream_iterator<std::string>(bin),
-                   [](const auto& c) { return word2Bin(c); });
-    return bin.str();
-}
+    uint32_t read(size_t n)
+    {
+        if (avail < n) {
+            while (avail <= 60) {
+                buffer = (buffer << 4) | (next < hex.size() ? nibbles[static_cast<uint8_t>(hex[next])] : 0);
+                avail += 4;
+                ++next;
+            }
+        }
+        avail -= n;
+        pos += n;
+        return static_cast<uint32_t>((buffer >> avail) & ((uint64_t{1} << n) - 1));
+    }
+
+    size_t position() const
+    {
+        return pos;
+    }
+
+private:
+    static constexpr std::array<uint8_t, 256> nibbles = [] {
+        std::array<uint8_t, 256> table{};
+        for (uint8_t i = 0; i < 10; ++i) {
+            table['0' + i] = i;
+        }
+        for (uint8_t i = 0; i < 6; ++i) {
+            table['A' + i] = 10 + i;
+            table['a' + i] = 10 + i;
+        }
+        return table;
+    }();
+
+    const std::string& hex;
+    uint64_t buffer{0};
+    size_t avail{0};
+    size_t next{0};
+    size_t pos{0};
+};
 
 enum class Kind
 {
@@ -93,20 +94,20 @@ enum class Kind
 struct Package
 {
     Kind kind{Kind::Root};
-    std::string ver{};
+    int ver{-1};
     uint64_t val{0};
     Package()
     {
     }
-    Package(const std::string& ver, Kind kind, uint64_t val = 0) : ver{ver}, kind{kind}, val{val}
+    Package(int ver, Kind kind, uint64_t val = 0) : kind{kind}, ver{ver}, val{val}
     {
     }
 };
 
 static std::ostream& operator<<(std::ostream& stream, const Package& package)
 {
-    if (!package.ver.empty()) {
-        stream << 'v' << std::stoi(package.ver, nullptr, 2);
+    if (package.ver >= 0) {
+        stream << 'v' << package.ver;
     }
     if (package.kind == Kind::OperationSum) {
         stream << " sum ";
@@ -132,95 +133,99 @@ static std::ostream& operator<<(std::ostream& stream, const Package& package)
 using PackageRef = NodeRef<Package>;
 NodeAlloc<Package> alloc{};
 
-static size_t parse(PackageRef& tree, const std::string& s, size_t& pos, size_t endPos, bool singlePass = false)
+constexpr std::array<Kind, 8> kinds{Kind::OperationSum,     Kind::OperationProduct, Kind::OperationMin,
+                                    Kind::OperationMax,     Kind::Literal,          Kind::OperationGreater,
+                                    Kind::OperationLess,    Kind::OperationEqual};
+
+// Operator whose sub-packets are still being read
+struct Frame
+{
+    Kind kind;
+    bool isLength;
+    size_t end;  // Bit position for a length, remaining sub-packets for a count
+    uint64_t val{0};
+    bool hasVal{false};
+    Node<Package>* node{nullptr};
+};
+
+static void combine(Frame& frame, uint64_t val)
+{
+    if (!frame.hasVal) {
+        frame.val = val;
+        frame.hasVal = true;
+    } else if (frame.kind == Kind::OperationSum) {
+        frame.val += val;
+    } else if (frame.kind == Kind::OperationProduct) {
+        frame.val *= val;
+    } else if (frame.kind == Kind::OperationMin) {
+        frame.val = std::min(frame.val, val);
+    } else if (frame.kind == Kind::OperationMax) {
+        frame.val = std::max(frame.val, val);
+    } else if (frame.kind == Kind::OperationGreater) {
+        frame.val = frame.val > val ? 1 : 0;
+    } else if (frame.kind == Kind::OperationLess) {
+        frame.val = frame.val < val ? 1 : 0;
+    } else if (frame.kind == Kind::OperationEqual) {
+        frame.val = frame.val == val ? 1 : 0;
+    }
+    if (!frame.isLength) {
+        --frame.end;
+    }
+}
+
+// Decodes and evaluates the outermost packet in one pass with an explicit stack, the tree is only built for a root
+static std::pair<uint64_t, uint64_t> decode(BitReader& reader, Node<Package>* root = nullptr)
 {
-    size_t sum{0};
-    while (pos < endPos - 7) {
-        auto ver = s.substr(pos, 3);
-        sum += std::stoi(ver, nullptr, 2);
-        pos += ver.size();
-        auto id = s.substr(pos, 3);
-        pos += id.size();
-        if (id == "100") {
-            const auto kind{Kind::Literal};
-            std::stringstream ss;
-            while (s[pos++] == '1') {
-                auto l = s.substr(pos, 4);
-                ss << l;
-                pos += l.size();
+    uint64_t sum{0};
+    std::vector<Frame> frames{};
+    while (true) {
+        const auto ver{reader.read(3)};
+        sum += ver;
+        const auto kind{kinds[reader.read(3)]};
+        auto* parent = frames.empty() ? root : frames.back().node;
+        if (kind != Kind::Literal) {
+            const auto isLength{reader.read(1) == 0};
+            size_t end;
+            if (isLength) {
+                const auto length{reader.read(15)};
+                end = reader.position() + length;
+            } else {
+                end = reader.read(11);
             }
-            auto l = s.substr(pos, 4);
-            ss << l;
-            pos += l.size();
-            tree->addNode(alloc, Package(ver, kind, std::stoull(ss.str(), nullptr, 2)));
+            Frame frame{kind, isLength, end};
+            if (parent) {
+                frame.node = parent->addNode(alloc, Package(ver, kind))->get();
+            }
+            frames.push_back(frame);
         } else {
-            // Operator
-            auto kind{Kind::Root};
-            if (id == "000") {
-                kind = Kind::OperationSum;
-            } else if (id == "001") {
-                kind = Kind::OperationProduct;
-            } else if (id == "010") {
-                kind = Kind::OperationMin;
-            } else if (id == "011") {
-                kind = Kind::OperationMax;
-            } else if (id == "101") {
-                kind = Kind::OperationGreater;
-            } else if (id == "110") {
-                kind = Kind::OperationLess;
-            } else if (id == "111") {
-                kind = Kind::OperationEqual;
+            uint64_t val{0};
+            uint32_t group{0};
+            do {
+                group = reader.read(5);
+                val = (val << 4) | (group & 0xF);
+            } while (group & 0x10);
+            if (parent) {
+                parent->addNode(alloc, Package(ver, kind, val));
             }
-            if (s[pos] == '0') {
-                auto len = s.substr(++pos, 15);
-                pos += len.size();
-                auto sub = tree->addNode(alloc, Package(ver, kind));
-                sum += parse(*sub, s, pos, pos + std::stoi(len, nullptr, 2));
-            } else if (s[pos] == '1') {
-                auto len = s.substr(++pos, 11);
-                pos += len.size();
-                auto sub = tree->addNode(alloc, Package(ver, kind));
-                for (int count = 0; count < std::stoi(len, nullptr, 2); ++count) {
-                    sum += parse(*sub, s, pos, endPos, true);
-                }
+            if (frames.empty()) {
+                return {sum, val};
             }
+            combine(frames.back(), val);
         }
-        if (singlePass) {
-            break;
+        // Complete all operators whose sub-packets are read
+        while (!frames.empty() &&
+               (frames.back().isLength ? reader.position() >= frames.back().end : frames.back().end == 0)) {
+            const auto frame{frames.back()};
+            frames.pop_back();
+            if (frame.node) {
+                frame.node->val.val = frame.val;
+            }
+            if (frames.empty()) {
+                return {sum, frame.val};
+            }
+            combine(frames.back(), frame.val);
         }
     }
-    return sum;
-}
-
-static uint64_t calc(PackageRef& tree)
-{
-    uint64_t res{tree->val.val};
-    std::vector<uint64_t> resVec{};
-    for (size_t i = 0; i < tree->nodes.size(); ++i) {
-        tree->nodes[i]->val.val = calc(tree->nodes[i]);
-        resVec.push_back(tree->nodes[i]->val.val);
-    }
-
-    if (tree->val.kind == Kind::OperationMax) {
-        res = *std::max_element(resVec.begin(), resVec.end());
-    } else if (tree->val.kind == Kind::OperationMin) {
-        res = *std::min_element(resVec.begin(), resVec.end());
-    } else if (tree->val.kind == Kind::OperationSum) {
-        res = std::accumulate(resVec.begin(), resVec.end(), uint64_t{0}, std::plus<uint64_t>());
-    } else if (tree->val.kind == Kind::OperationProduct) {
-        res = std::accumulate(resVec.begin(), resVec.end(), uint64_t{1}, std::multiplies<uint64_t>());
-    } else if (tree->val.kind == Kind::OperationGreater) {
-        res = (resVec[0] > resVec[1]) ? 1 : 0;
-    } else if (tree->val.kind == Kind::OperationLess) {
-        res = (resVec[0] < resVec[1]) ? 1 : 0;
-    } else if (tree->val.kind == Kind::OperationEqual) {
-        res = (resVec[0] == resVec[1]) ? 1 : 0;
-    } else if (tree->val.kind == Kind::Root) {
-        tree->val.val = tree->nodes[0]->val.val;
-        res = tree->val.val;
-    }
-
-    return res;
 }
 
 int main(int argc, char* argv[])
@@ -235,13 +240,18 @@ int main(int argc, char* argv[])
         return EXIT_FAILURE;
     }
 
-    const auto s{hex2Bin(lines[0])};
-    size_t pos{0};
-    auto root{allocate_unique<Node<Package> >(alloc, Package())};
-    auto ver = parse(root, s, pos, s.size());
-    std::cout << ver << std::endl;
-    calc(root);
-    root->print();
+    BitReader reader{lines[0]};
+    if (printTree) {
+        auto root{allocate_unique<Node<Package> >(alloc, Package())};
+        const auto [ver, val] = decode(reader, root.get());
+        root->val.val = val;
+        std::cout << ver << std::endl;
+        root->print();
+    } else {
+        const auto [ver, val] = decode(reader);
+        std::cout << ver << std::endl;
+        std::cout << val << std::endl;
+    }
 
     return EXIT_SUCCESS;
 }
@@ -3,8 +3,11 @@
 // https://adventofcode.com/2021/day/17
 
 #include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <fstream>
 #include <iostream>
+#include <limits>
 #include <string>
 #include <vector>
 
@@ -25,38 +28,99 @@ static bool readFile(std::string fileName, std::vector<std::string>& lines)
     return true;
 }
 
-using Point = std::pair<int, int>;
-using Velocity = std::pair<int, int>;
+using Number = int64_t;
+using Point = std::pair<Number, Number>;
+using Steps = std::pair<Number, Number>;  // Closed range of step counts
 
-template <typename T>
-static int sgn(T val)
+constexpr Number infinite{std::numeric_limits<Number>::max()};
+
+// Position after n steps with initial velocity v and a deceleration of one per step, without drag stop
+inline static Number position(Number v, Number n)
 {
-    return (T{0} < val) - (val < T{0});
+    return n * v - n * (n - 1) / 2;
 }
 
-static void increment(Point& point, Velocity& velocity)
+// Largest n with position(v, n) >= bound on the descending branch, requires bound <= 0
+static Number lastStepAtLeast(Number v, Number bound)
 {
-    auto& [x, y] = point;
-    auto& [vx, vy] = velocity;
-    x += vx;
-    y += vy;
-    vx -= sgn<int>(vx);
-    vy -= 1;
+    const double b{2. * v + 1.};
+    auto n{static_cast<Number>((b + std::sqrt(b * b - 8. * bound)) / 2.)};
+    while (position(v, n + 1) >= bound) {
+        ++n;
+    }
+    while (n > 0 && position(v, n) < bound) {
+        --n;
+    }
+    return n;
 }
 
-inline static bool isHit(const Point& point, const Point& xtarget, const Point& ytarget)
+// Smallest n with position(v, n) >= bound on the ascending branch, requires v * (v + 1) / 2 >= bound
+static Number firstStepAtLeast(Number v, Number bound)
 {
-    auto& [x, y] = point;
-    auto& [xmin, xmax] = xtarget;
-    auto& [ymin, ymax] = ytarget;
-    return x >= xmin && x <= xmax && y >= ymin && y <= ymax;
+    const double b{2. * v + 1.};
+    auto n{std::max<Number>(0, static_cast<Number>(std::ceil((b - std::sqrt(b * b - 8. * bound)) / 2.)))};
+    while (n > 0 && position(v, n - 1) >= bound) {
+        --n;
+    }
+    while (position(v, n) < bound) {
+        ++n;
+    }
+    return n;
 }
 
-static std::ostream& operator<<(std::ostream& stream, const Velocity& velocity)
+// Steps with x within the target, the probe stops after vx steps and may stay there forever
+static Steps xSteps(Number vx, const Point& xtarget)
 {
-    auto& [vx, vy] = velocity;
-    stream << vx << ", " << vy;
-    return stream;
+    const auto& [xmin, xmax] = xtarget;
+    const auto stop{position(vx, vx)};
+    if (stop < xmin) {
+        return {1, 0};
+    }
+    const auto first{firstStepAtLeast(vx, xmin)};
+    const auto last{stop <= xmax ? infinite : firstStepAtLeast(vx, xmax + 1) - 1};
+    return {first, last};
+}
+
+// Steps with y within the target, which lies below the start
+static Steps ySteps(Number vy, const Point& ytarget)
+{
+    const auto& [ymin, ymax] = ytarget;
+    return {lastStepAtLeast(vy, ymax + 1) + 1, lastStepAtLeast(vy, ymin)};
+}
+
+// Joins the step ranges per vx and per vy without simulating: two ranges intersect unless one ends before the
+// other starts, which is counted by binary search over the sorted range bounds
+static std::pair<Number, size_t> solve(const Point& xtarget, const Point& ytarget)
+{
+    std::vector<Number> firsts{};
+    std::vector<Number> lasts{};
+    for (Number vx = 1; vx <= xtarget.second; ++vx) {
+        const auto [first, last] = xSteps(vx, xtarget);
+        if (first <= last) {
+            firsts.push_back(first);
+            lasts.push_back(last);
+        }
+    }
+    std::sort(firsts.begin(), firsts.end());
+    std::sort(lasts.begin(), lasts.end());
+
+    Number ymax{0};
+    size_t count{0};
+    // Probes launched faster upwards pass y = 0 again below the target
+    for (Number vy = ytarget.first; vy < -ytarget.first; ++vy) {
+        const auto [first, last] = ySteps(vy, ytarget);
+        if (first > last) {
+            continue;
+        }
+        const auto startAfter{std::distance(std::upper_bound(firsts.cbegin(), firsts.cend(), last), firsts.cend())};
+        const auto endBefore{std::distance(lasts.cbegin(), std::lower_bound(lasts.cbegin(), lasts.cend(), first))};
+        const auto hits{firsts.size() - startAfter - endBefore};
+        if (hits > 0) {
+            count += hits;
+            ymax = std::max(ymax, position(vy, std::max<Number>(vy, 0)));
+        }
+    }
+    return {ymax, count};
 }
 
 int main(int argc, char* argv[])
@@ -78,41 +142,16 @@ int main(int argc, char* argv[])
     auto p4{lines[0].rfind('=')};
     auto p5{lines[0].rfind('.')};
 
-    Point xtarget{std::stoi(lines[0].substr(p1 + 1, p2 - p1 - 1)), std::stoi(lines[0].substr(p2 + 2, p3 - p2 - 2))};
-    Point ytarget{std::stoi(lines[0].substr(p4 + 1, p5 - p4 - 2)),
-                  std::stoi(lines[0].substr(p5 + 1, lines[0].size() - p5))};
-
-    int vxmin{1};
-    for (int n = 1; n <= xtarget.second; ++n) {
-        if (n * (n + 1) >= 2 * xtarget.first) {
-            vxmin = n;
-            break;
-        }
+    Point xtarget{std::stoll(lines[0].substr(p1 + 1, p2 - p1 - 1)), std::stoll(lines[0].substr(p2 + 2, p3 - p2 - 2))};
+    Point ytarget{std::stoll(lines[0].substr(p4 + 1, p5 - p4 - 2)),
+                  std::stoll(lines[0].substr(p5 + 1, lines[0].size() - p5))};
+    // Target right of and below the start
+    if (xtarget.first <= 0 || ytarget.second >= 0) {
+        return EXIT_FAILURE;
     }
 
-    int ymaxGlobal{0};
-    size_t count{0};
-    const int vymin{-std::max<int>(std::abs(ytarget.first), std::abs(ytarget.second))};
-    for (int vx = vxmin; vx <= xtarget.second; ++vx) {
-        for (int vy = vymin; vy <= -vymin; ++vy) {
-            int ymax{0};
-            Point point{};
-            //Velocity v0{vx, vy};
-            Velocity v{vx, vy};
-            auto& [x, y] = point;
-            while (x <= xtarget.second && y >= ytarget.first) {
-                increment(point, v);
-                ymax = std::max<int>(ymax, point.second);
-                if (isHit(point, xtarget, ytarget)) {
-                    count++;
-                    ymaxGlobal = std::max<int>(ymax, ymaxGlobal);
-                    //std::cout << v0 << std::endl;
-                    break;
-                }
-            }
-        }
-    }
-    std::cout << ymaxGlobal << std::endl;
+    const auto [ymax, count] = solve(xtarget, ytarget);
+    std::cout << ymax << std::endl;
     std::cout << count << std::endl;
 
     return EXIT_SUCCESS;
@@ -3,11 +3,13 @@
 // https://adventofcode.com/2021/day/18
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
 #include <fstream>
 #include <iostream>
-#include <memory>
 #include <string>
-#include <variant>
+#include <thread>
 #include <vector>
 
 #include <gsl/util>
@@ -28,215 +30,181 @@ static bool readFile(std::string fileName, std::vector<std::string>& lines)
 }
 
 constexpr bool verbose{false};
-struct Node;
-using NodeRef = std::shared_ptr<Node>;
-using NodePair = std::pair<NodeRef, NodeRef>;
+// Leaves of a reduced sum of two numbers are at most at depth 5, thus at most 32
+constexpr size_t capacity{64};
 
-enum class Position
+struct Leaf
 {
-    LEFT,
-    RIGHT,
-    UNDEFINED
+    uint8_t val;
+    uint8_t depth;  // Number of enclosing pairs
 };
 
-struct Node
+// Snailfish number as its leaves in order, explode and split are local operations on the array
+struct Number
 {
-    Node()
-    {
-    }
-    Node(Position pos, const NodeRef& parent) : pos{pos}, parent{parent}
-    {
-    }
-    inline bool isNode() const
+    std::array<Leaf, capacity> leaves{};
+    size_t size{0};
+
+    void insert(size_t pos, const Leaf& leaf)
     {
-        return !isLeaf();
+        std::copy_backward(leaves.begin() + pos, leaves.begin() + size, leaves.begin() + size + 1);
+        leaves[pos] = leaf;
+        ++size;
     }
-    inline bool isLeaf() const
+
+    void erase(size_t pos)
     {
-        return std::holds_alternative<int>(p);
+        std::copy(leaves.begin() + pos + 1, leaves.begin() + size, leaves.begin() + pos);
+        --size;
     }
-    std::variant<NodePair, int> p{};
-    std::weak_ptr<Node> parent{};
-    Position pos{Position::UNDEFINED};
 };
 
-static std::ostream& print(std::ostream& stream, const NodeRef& node, int depth = 0)
+static size_t print(std::ostream& stream, const Number& number, size_t pos, uint8_t depth)
 {
-    if (node->isNode()) {
-        auto& [left, right] = std::get<NodePair>(node->p);
-        if (depth > 3) {
-            // Mark explode candidates for debugging
-            stream << "[~";
-        } else {
-            stream << "[";
-        }
-        print(stream, left, depth + 1);
-        stream << ",";
-        print(stream, right, depth + 1);
-        if (depth > 3) {
-            // Mark explode candidates for debugging
-            stream << "~]";
-        } else {
-            stream << "]";
-        }
-    } else {
-        auto& val = std::get<int>(node->p);
-        if (val >= 10) {
+    const auto& leaf{number.leaves[pos]};
+    if (leaf.depth == depth) {
+        if (leaf.val >= 10) {
             // Mark split candidates for debugging
-            stream << "*" << val << "*";
+            stream << "*" << int{leaf.val} << "*";
         } else {
-            stream << val;
+            stream << int{leaf.val};
         }
-    }
-    return stream;
+        return pos + 1;
+    }
+    // Mark explode candidates for debugging
+    stream << (depth > 3 ? "[~" : "[");
+    pos = print(stream, number, pos, depth + 1);
+    stream << ",";
+    pos = print(stream, number, pos, depth + 1);
+    stream << (depth > 3 ? "~]" : "]");
+    return pos;
 }
 
-static std::ostream& operator<<(std::ostream& stream, const NodeRef& node)
+static std::ostream& operator<<(std::ostream& stream, const Number& number)
 {
-    return print(stream, node);
-}
-
-static void parse(NodeRef& node, const std::string& s, size_t& pos)
-{
-    while (pos < s.size()) {
-        if (s[pos] == '[') {
-            ++pos;
-            auto left = std::make_shared<Node>(Position::LEFT, node);
-            auto right = std::make_shared<Node>(Position::RIGHT, node);
-            node->p = std::make_pair(left, right);
-            parse(left, s, pos);
-            parse(right, s, pos);
-        } else if (s[pos] == ',' || s[pos] == ']') {
-            ++pos;
-            break;
-        } else if (s[pos] >= '0' && s[pos] <= '9') {
-            node->p = s[pos++] - '0';
-        }
+    if (number.size > 0) {
+        print(stream, number, 0, 0);
     }
+    return stream;
 }
 
-static void incrementLeft(std::weak_ptr<Node> iter, int incr)
+static Number parse(const std::string& s)
 {
-    while (!iter.expired() && iter.lock()->pos != Position::RIGHT) {
-        iter = iter.lock()->parent;
-    }
-    if (!iter.expired()) {
-        iter = iter.lock()->parent;
-    }
-    if (!iter.expired()) {
-        if (iter.lock()->isNode()) {
-            auto& q = std::get<NodePair>(iter.lock()->p);
-            iter = q.first;
-        }
-        while (true) {
-            if (iter.lock()->isLeaf()) {
-                auto& val = std::get<int>(iter.lock()->p);
-                val += incr;
-                break;
-            } else {
-                auto& q = std::get<NodePair>(iter.lock()->p);
-                iter = q.second;
-            }
+    Number number{};
+    uint8_t depth{0};
+    for (const auto& c : s) {
+        if (c == '[') {
+            ++depth;
+        } else if (c == ']') {
+            --depth;
+        } else if (c >= '0' && c <= '9' && number.size < capacity) {
+            number.leaves[number.size++] = {static_cast<uint8_t>(c - '0'), depth};
         }
     }
+    return number;
 }
 
-static void incrementRight(std::weak_ptr<Node> iter, int incr)
+// The leftmost leaf at depth 5 is always the left element of a pair of regular numbers
+static bool tryExplode(Number& number)
 {
-    while (!iter.expired() && iter.lock()->pos != Position::LEFT) {
-        iter = iter.lock()->parent;
-    }
-    if (!iter.expired()) {
-        iter = iter.lock()->parent;
-    }
-    if (!iter.expired()) {
-        if (iter.lock()->isNode()) {
-            auto& q = std::get<NodePair>(iter.lock()->p);
-            iter = q.second;
-        }
-        while (true) {
-            if (iter.lock()->isLeaf()) {
-                auto& val = std::get<int>(iter.lock()->p);
-                val += incr;
-                break;
-            } else {
-                auto& q = std::get<NodePair>(iter.lock()->p);
-                iter = q.first;
+    auto& leaves = number.leaves;
+    for (size_t i = 0; i + 1 < number.size; ++i) {
+        if (leaves[i].depth > 4) {
+            if (i > 0) {
+                leaves[i - 1].val += leaves[i].val;
+            }
+            if (i + 2 < number.size) {
+                leaves[i + 2].val += leaves[i + 1].val;
             }
+            leaves[i] = {0, static_cast<uint8_t>(leaves[i].depth - 1)};
+            number.erase(i + 1);
+            return true;
         }
     }
+    return false;
 }
 
-static bool tryExplode(NodeRef& node, const int depth = 0)
-{
-    if (node->isLeaf())
-        return false;
-
-    auto& [left, right] = std::get<NodePair>(node->p);
-    if (depth > 3 && left->isLeaf() && right->isLeaf()) {
-        incrementLeft(node, std::get<int>(left->p));
-        incrementRight(node, std::get<int>(right->p));
-        node->p = 0;
-        return true;
-    }
-
-    return tryExplode(left, depth + 1) || tryExplode(right, depth + 1);
-}
-
-static bool trySplit(NodeRef& node)
+static bool trySplit(Number& number)
 {
-    if (node->isNode()) {
-        auto& [left, right] = std::get<NodePair>(node->p);
-        return trySplit(left) || trySplit(right);
-    }
-
-    if (const auto val = std::get<int>(node->p); val >= 10) {
-        const auto left = std::make_shared<Node>(Position::LEFT, node);
-        const auto right = std::make_shared<Node>(Position::RIGHT, node);
-        node->p = std::make_pair(left, right);
-        left->p = static_cast<int>(floor(val / 2.0));
-        right->p = static_cast<int>(ceil(val / 2.0));
-        return true;
+    auto& leaves = number.leaves;
+    for (size_t i = 0; i < number.size; ++i) {
+        if (const auto [val, depth] = leaves[i]; val >= 10) {
+            leaves[i] = {static_cast<uint8_t>(val / 2), static_cast<uint8_t>(depth + 1)};
+            number.insert(i + 1, {static_cast<uint8_t>(val - val / 2), static_cast<uint8_t>(depth + 1)});
+            return true;
+        }
     }
-
     return false;
 }
 
-static NodeRef reduce(NodeRef& node, bool verbose = false)
+static void reduce(Number& number, bool verbose = false)
 {
     if (verbose)
-        std::cout << "R: " << node << std::endl;
+        std::cout << "R: " << number << std::endl;
     while (true) {
-        while (tryExplode(node)) {
+        while (tryExplode(number)) {
             if (verbose)
-                std::cout << "E: " << node << std::endl;
+                std::cout << "E: " << number << std::endl;
         }
-        if (!trySplit(node))
+        if (!trySplit(number))
             break;
         if (verbose)
-            std::cout << "S: " << node << std::endl;
+            std::cout << "S: " << number << std::endl;
     }
-    return node;
 }
 
-static NodeRef add(NodeRef& left, NodeRef& right)
+static Number add(const Number& left, const Number& right)
 {
-    auto sum = std::make_shared<Node>();
-    sum->p = std::make_pair(left, right);
-    left->parent = sum;
-    left->pos = Position::LEFT;
-    right->parent = sum;
-    right->pos = Position::RIGHT;
-    return reduce(sum, verbose);
+    Number sum{};
+    for (size_t i = 0; i < left.size; ++i) {
+        sum.leaves[sum.size++] = {left.leaves[i].val, static_cast<uint8_t>(left.leaves[i].depth + 1)};
+    }
+    for (size_t i = 0; i < right.size; ++i) {
+        sum.leaves[sum.size++] = {right.leaves[i].val, static_cast<uint8_t>(right.leaves[i].depth + 1)};
+    }
+    reduce(sum, verbose);
+    return sum;
 }
 
-static int magnitude(const NodeRef& node)
+// Folds sibling leaves bottom-up on a stack
+static int magnitude(const Number& number)
 {
-    if (node->isNode()) {
-        auto& [left, right] = std::get<NodePair>(node->p);
-        return 3 * magnitude(left) + 2 * magnitude(right);
+    std::array<std::pair<int, uint8_t>, capacity> stack{};
+    size_t size{0};
+    for (size_t i = 0; i < number.size; ++i) {
+        stack[size++] = {number.leaves[i].val, number.leaves[i].depth};
+        while (size > 1 && stack[size - 1].second == stack[size - 2].second) {
+            const auto right{stack[--size].first};
+            auto& [left, depth] = stack[size - 1];
+            left = 3 * left + 2 * right;
+            --depth;
+        }
     }
-    return std::get<int>(node->p);
+    return size > 0 ? stack[0].first : 0;
+}
+
+// Largest magnitude over all ordered pairs, the rows of the pair matrix are shared out to worker threads
+static int maxMagnitude(const std::vector<Number>& numbers)
+{
+    const auto n{numbers.size()};
+    const auto threads{std::max<size_t>(1, std::min<size_t>(std::thread::hardware_concurrency(), n))};
+    std::atomic<size_t> next{0};
+    std::vector<int> maxs(threads, 0);
+    std::vector<std::thread> workers{};
+    workers.reserve(threads);
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            for (auto i = next++; i < n; i = next++) {
+                for (size_t j = 0; j < n; ++j) {
+                    if (i != j) {
+                        maxs[t] = std::max(maxs[t], magnitude(add(numbers[i], numbers[j])));
+                    }
+                }
+            }
+        });
+    }
+    std::for_each(workers.begin(), workers.end(), [](auto& worker) { worker.join(); });
+    return *std::max_element(maxs.cbegin(), maxs.cend());
 }
 
 int main(int argc, char* argv[])
@@ -248,16 +216,18 @@ int main(int argc, char* argv[])
         }
     }
 
-    {  // Part 1
-        std::vector<NodeRef> numbers{};
-        numbers.reserve(lines.size());
-        for (const auto& line : lines) {
-            size_t pos{0};
-            auto root = std::make_shared<Node>();
-            numbers.emplace_back(root);
-            parse(numbers.back(), line, pos);
+    std::vector<Number> numbers{};
+    numbers.reserve(lines.size());
+    for (const auto& line : lines) {
+        if (!line.empty()) {
+            numbers.push_back(parse(line));
         }
+    }
+    if (numbers.empty()) {
+        return EXIT_FAILURE;
+    }
 
+    {  // Part 1
         auto sum = numbers[0];
         for (size_t i = 0; i < numbers.size() - 1; ++i) {
             sum = add(sum, numbers[i + 1]);
@@ -265,23 +235,7 @@ int main(int argc, char* argv[])
         std::cout << magnitude(sum) << std::endl;
     }
     {  // Part 2
-        int maxMagnitude{0};
-        for (size_t i = 0; i < lines.size(); ++i) {
-            for (size_t j = 0; j < lines.size(); j++) {
-                if (i == j) {
-                    continue;
-                }
-                size_t pos{0};
-                auto left = std::make_shared<Node>();
-                parse(left, lines[i], pos);
-                pos = 0;
-                auto right = std::make_shared<Node>();
-                parse(right, lines[j], pos);
-                auto sum = add(left, right);
-                maxMagnitude = std::max(magnitude(sum), maxMagnitude);
-            }
-        }
-        std::cout << maxMagnitude << std::endl;
+        std::cout << maxMagnitude(numbers) << std::endl;
     }
 
     return EXIT_SUCCESS;
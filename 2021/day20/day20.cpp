@@ -3,9 +3,12 @@
 // https://adventofcode.com/2021/day/20
 
 #include <algorithm>
+#include <bitset>
+#include <cstdint>
 #include <fstream>
 #include <iostream>
 #include <numeric>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -31,68 +34,153 @@ using Image = std::vector<std::string>;
 constexpr std::string::value_type dark{'.'};
 constexpr std::string::value_type light{'#'};
 
-static std::ostream& operator<<(std::ostream& stream, const Image& image)
+// Image stored as bit rows on a canvas that fits all steps, pixels beyond the canvas are the infinite background
+class Enhancer
 {
-    std::for_each(image.cbegin(), image.cend(), [&](const auto& row) { stream << row << '\n'; });
-    return stream;
-}
+public:
+    Enhancer(const Image& image, const std::string& map, size_t maxSteps)
+        : margin{maxSteps},
+          height{image.size()},
+          width{image[0].size()},
+          rows{height + 2 * maxSteps},
+          cols{width + 2 * maxSteps},
+          words{(cols + 63) / 64},
+          tailMask{cols % 64 == 0 ? 0 : UINT64_MAX << (cols % 64)},
+          cur(rows * words, 0),
+          next(rows * words, 0),
+          bgRow(words, 0)
+    {
+        for (size_t i = 0; i < map.size() && i < lut.size(); ++i) {
+            lut[i] = map[i] == light;
+        }
+        for (size_t i = 0; i < height; ++i) {
+            for (size_t j = 0; j < width; ++j) {
+                if (image[i][j] == light) {
+                    cur[(margin + i) * words + (margin + j) / 64] |= uint64_t{1} << ((margin + j) % 64);
+                }
+            }
+        }
+    }
 
-static void shrink(Image& image)
-{
-    image.erase(image.begin());
-    image.pop_back();
-    std::transform(image.begin(), image.end(), image.begin(), [](auto& row) { return row.substr(1, row.size() - 2); });
-}
+    // Double-buffered step, each row word is loaded into registers that are shifted by one column per pixel to
+    // slide the 9-bit index along the row
+    void step()
+    {
+        const auto bg{background ? uint64_t{1} : uint64_t{0}};
+        for (size_t i = 0; i < rows; ++i) {
+            const auto* up = i > 0 ? &cur[(i - 1) * words] : bgRow.data();
+            const auto* mid = &cur[i * words];
+            const auto* down = i + 1 < rows ? &cur[(i + 1) * words] : bgRow.data();
+            auto* out = &next[i * words];
+            // Left background column and first column
+            size_t index{((bg * 0b001001001) << 1) | ((up[0] & 1) << 6) | ((mid[0] & 1) << 3) | (down[0] & 1)};
+            for (size_t w = 0; w < words; ++w) {
+                // Bit b holds the column right of pixel 64 * w + b
+                auto u{ahead(up, w)};
+                auto m{ahead(mid, w)};
+                auto d{ahead(down, w)};
+                uint64_t result{0};
+                const auto n{std::min<size_t>(64, cols - 64 * w)};
+                for (size_t b = 0; b < n; ++b, u >>= 1, m >>= 1, d >>= 1) {
+                    index = ((index << 1) & 0b110110110) | ((u & 1) << 6) | ((m & 1) << 3) | (d & 1);
+                    result |= uint64_t{lut[index]} << b;
+                }
+                out[w] = result;
+            }
+        }
+        std::swap(cur, next);
+        if (lut[background ? 511 : 0] != background) {
+            background = !background;
+            std::fill(bgRow.begin(), bgRow.end(), background ? UINT64_MAX : 0);
+        }
+        ++steps;
+    }
 
-static void enlarge(Image& image, std::string::value_type c)
-{
-    const std::string border(image[0].size(), c);
-    image.insert(image.begin(), border);
-    image.emplace_back(border);
-    std::transform(image.begin(), image.end(), image.begin(), [c](auto& row) { return c + std::move(row) + c; });
-}
+    bool isBackgroundLit() const
+    {
+        return background;
+    }
 
-static Image enhance(Image& image, const std::string& map, std::string::value_type c)
-{
-    enlarge(image, c);
-    enlarge(image, c);
-    Image copy{image};
-    size_t dim{image[0].size()};
-    for (size_t i = 1; i < dim - 1; ++i) {
-        for (size_t j = 1; j < dim - 1; ++j) {
-            size_t index{0};
-            // clang-format off
-            if (image[i - 1][j - 1] == light) index += 256;
-            if (image[i - 1][j    ] == light) index += 128;
-            if (image[i - 1][j + 1] == light) index += 64;
-            if (image[i    ][j - 1] == light) index += 32;
-            if (image[i    ][j    ] == light) index += 16;
-            if (image[i    ][j + 1] == light) index += 8;
-            if (image[i + 1][j - 1] == light) index += 4;
-            if (image[i + 1][j    ] == light) index += 2;
-            if (image[i + 1][j + 1] == light) index += 1;
-            // clang-format on
-            copy[i][j] = map[index];
+    // Lit pixels within the canvas, the pixels beyond are lit as well if the background is lit
+    size_t count() const
+    {
+        return std::accumulate(cur.cbegin(), cur.cend(), size_t{0},
+                               [](auto a, const auto w) { return a + std::bitset<64>(w).count(); });
+    }
+
+    // Prints the part of the canvas reached by the steps done so far
+    void print(std::ostream& stream) const
+    {
+        for (size_t i = margin - steps; i < margin + height + steps; ++i) {
+            for (size_t j = margin - steps; j < margin + width + steps; ++j) {
+                stream << (bit(&cur[i * words], j) ? light : dark);
+            }
+            stream << '\n';
         }
     }
-    shrink(copy);
-    return copy;
+
+private:
+    // Word w of the row with the background beyond the canvas
+    uint64_t load(const uint64_t* row, size_t w) const
+    {
+        return w + 1 < words ? row[w] : row[w] | (background ? tailMask : 0);
+    }
+
+    // Word w of the row shifted by one column, pulling in the first column of the next word
+    uint64_t ahead(const uint64_t* row, size_t w) const
+    {
+        const auto nextBit{w + 1 < words ? load(row, w + 1) & 1 : (background ? uint64_t{1} : uint64_t{0})};
+        return (load(row, w) >> 1) | (nextBit << 63);
+    }
+
+    static uint64_t bit(const uint64_t* row, size_t j)
+    {
+        return (row[j / 64] >> (j % 64)) & 1;
+    }
+
+    size_t margin;
+    size_t height;
+    size_t width;
+    size_t rows;
+    size_t cols;
+    size_t words;
+    // Bits of the last word beyond the canvas
+    uint64_t tailMask;
+    std::vector<uint64_t> cur;
+    std::vector<uint64_t> next;
+    // Row beyond the canvas, refilled when the background flips
+    std::vector<uint64_t> bgRow;
+    std::bitset<512> lut{};
+    bool background{false};
+    size_t steps{0};
+};
+
+static std::ostream& operator<<(std::ostream& stream, const Enhancer& enhancer)
+{
+    enhancer.print(stream);
+    return stream;
 }
 
-static size_t enhance(Image& image, const std::string& map, size_t end)
+// Lit pixels after the given further steps, none if the infinite background is lit
+static std::optional<size_t> enhance(Enhancer& enhancer, size_t end)
 {
     for (size_t i = 0; i < end; ++i) {
-        std::string::value_type c{dark};
-        if (i % 2 == 1 && map[0] == light && map[map.size() - 1] == dark) {
-            c = light;
-        }
-        image = enhance(image, map, c);
+        enhancer.step();
         if (verbose)
-            std::cout << image << std::endl;
+            std::cout << enhancer << std::endl;
+    }
+    if (enhancer.isBackgroundLit()) {
+        return std::nullopt;
+    }
+    return enhancer.count();
+}
+
+static std::ostream& operator<<(std::ostream& stream, const std::optional<size_t>& count)
+{
+    if (count) {
+        return stream << *count;
     }
-    return std::accumulate(image.begin(), image.end(), size_t{0}, [](auto& a, auto& row) {
-        return a + std::count_if(row.begin(), row.end(), [](const auto c) { return c == light; });
-    });
+    return stream << "infinite";
 }
 
 int main(int argc, char* argv[])
@@ -116,10 +204,11 @@ int main(int argc, char* argv[])
         return EXIT_FAILURE;
     }
     const auto& map{lines[0]};
+    Enhancer enhancer{image, map, 50};
     if (verbose)
-        std::cout << image << std::endl;
-    auto count1{enhance(image, map, size_t{2})};
-    auto count2{enhance(image, map, size_t{48})};
+        std::cout << enhancer << std::endl;
+    auto count1{enhance(enhancer, size_t{2})};
+    auto count2{enhance(enhancer, size_t{48})};
     std::cout << count1 << '\n' << count2 << std::endl;
 
     return EXIT_SUCCESS;
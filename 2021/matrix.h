@@ -0,0 +1,154 @@
+// Small fixed-size matrices with exponentiation by squaring for linear recurrences, shared by the days of 2021
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+template <typename T, size_t N>
+using Vector = std::array<T, N>;
+
+template <typename T, size_t N>
+using Matrix = std::array<Vector<T, N>, N>;
+
+// Native 64-bit arithmetic, exact as long as all results stay below 2^64
+struct Wrapping
+{
+    using value_type = uint64_t;
+
+    static constexpr value_type add(value_type a, value_type b) noexcept
+    {
+        return a + b;
+    }
+
+    static constexpr value_type mul(value_type a, value_type b) noexcept
+    {
+        return a * b;
+    }
+
+    template <typename A>
+    static void normalize(A&) noexcept
+    {
+    }
+};
+
+// Arithmetic modulo P, with P < 2^32 such that all products fit into 64 bits
+template <uint32_t P>
+struct Modular
+{
+    using value_type = uint64_t;
+
+    static constexpr value_type add(value_type a, value_type b) noexcept
+    {
+        return (a + b) % P;
+    }
+
+    static constexpr value_type mul(value_type a, value_type b) noexcept
+    {
+        return a * b % P;
+    }
+
+    template <typename A>
+    static void normalize(A&) noexcept
+    {
+    }
+};
+
+// Floating-point arithmetic, rescaled to the largest entry such that only the ratios of the results are kept
+struct Floating
+{
+    using value_type = double;
+
+    static constexpr value_type add(value_type a, value_type b) noexcept
+    {
+        return a + b;
+    }
+
+    static constexpr value_type mul(value_type a, value_type b) noexcept
+    {
+        return a * b;
+    }
+
+    template <size_t N>
+    static void normalize(Vector<value_type, N>& v) noexcept
+    {
+        const auto max{*std::max_element(v.cbegin(), v.cend())};
+        if (max > 0) {
+            std::for_each(v.begin(), v.end(), [max](auto& x) { x /= max; });
+        }
+    }
+
+    template <size_t N>
+    static void normalize(Matrix<value_type, N>& m) noexcept
+    {
+        value_type max{0};
+        for (const auto& row : m) {
+            max = std::max(max, *std::max_element(row.cbegin(), row.cend()));
+        }
+        if (max > 0) {
+            for (auto& row : m) {
+                std::for_each(row.begin(), row.end(), [max](auto& x) { x /= max; });
+            }
+        }
+    }
+};
+
+// c = a * b, c must not alias a or b
+template <typename Arith, size_t N>
+void multiply(const Matrix<typename Arith::value_type, N>& a, const Matrix<typename Arith::value_type, N>& b,
+              Matrix<typename Arith::value_type, N>& c)
+{
+    for (auto& row : c) {
+        row.fill(0);
+    }
+    for (size_t i = 0; i < N; ++i) {
+        for (size_t k = 0; k < N; ++k) {
+            const auto aik{a[i][k]};
+            if (aik == 0) {
+                continue;
+            }
+            for (size_t j = 0; j < N; ++j) {
+                c[i][j] = Arith::add(c[i][j], Arith::mul(aik, b[k][j]));
+            }
+        }
+    }
+}
+
+template <typename Arith, size_t N>
+Vector<typename Arith::value_type, N> apply(const Matrix<typename Arith::value_type, N>& m,
+                                            const Vector<typename Arith::value_type, N>& v)
+{
+    Vector<typename Arith::value_type, N> r{};
+    for (size_t i = 0; i < N; ++i) {
+        for (size_t j = 0; j < N; ++j) {
+            r[i] = Arith::add(r[i], Arith::mul(m[i][j], v[j]));
+        }
+    }
+    return r;
+}
+
+// Returns m^e * v in O(N^3 log e), the matrices are kept on the heap to allow for larger N
+template <typename Arith, size_t N>
+Vector<typename Arith::value_type, N> power(const Matrix<typename Arith::value_type, N>& m,
+                                            Vector<typename Arith::value_type, N> v, uint64_t e)
+{
+    using M = Matrix<typename Arith::value_type, N>;
+    auto base{std::make_unique<M>(m)};
+    auto tmp{std::make_unique<M>()};
+    while (e > 0) {
+        if (e & 1) {
+            v = apply<Arith, N>(*base, v);
+            Arith::normalize(v);
+        }
+        e >>= 1;
+        if (e > 0) {
+            multiply<Arith, N>(*base, *base, *tmp);
+            std::swap(base, tmp);
+            Arith::normalize(*base);
+        }
+    }
+    return v;
+}
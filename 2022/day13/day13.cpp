@@ -3,13 +3,12 @@
 // https://adventofcode.com/2022/day/13
 
 #include <algorithm>
-#include <assert.h>
+#include <cstdint>
 #include <fstream>
 #include <iostream>
-#include <memory>
 #include <numeric>
-#include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include <gsl/util>
@@ -29,144 +28,147 @@ static bool readFile(std::string fileName, std::vector<std::string>& lines)
     return true;
 }
 
-constexpr bool verbose{false};
-struct Node;
-using NodeRef = std::shared_ptr<Node>;
-using NodeRefs = std::vector<NodeRef>;
+enum class Token
+{
+    open,
+    close,
+    number,
+    end
+};
 
-struct Node
+// Reads the tokens of a packet string on the fly, an integer promoted to a list is followed by virtual closing
+// brackets once it is consumed
+class Cursor
 {
-    Node()
-    {
-    }
-    explicit Node(const std::string& s)
+public:
+    explicit Cursor(std::string_view s) : s{s}
     {
-        size_t start{1};
-        size_t end{s.size() - 1};
-        // Skip first "[" and last "]" for root
-        parse(s, start, end);
     }
-    NodeRefs nodes{};
-    std::optional<int> v{std::nullopt};
-    friend std::ostream& operator<<(std::ostream& stream, const NodeRef& node);
 
-private:
-    void parse(const std::string& s, size_t& pos, size_t end)
+    Token peek()
     {
-        while (pos < end) {
-            if (s[pos] == '[') {
-                ++pos;
-                auto next = std::make_shared<Node>();
-                nodes.push_back(next);
-                next->parse(s, pos, end);
-            } else if (s[pos] == ']') {
-                ++pos;
-                break;
-            } else if (s[pos] == ',') {
-                ++pos;
-            } else {
-                auto next = std::make_shared<Node>();
-                auto start = pos;
-                while (s[pos] >= '0' && s[pos] <= '9') {
-                    pos++;
-                }
-                next->v = std::stoi(s.substr(start, pos - start));
-                nodes.push_back(next);
-            }
+        if (virtualCloses > 0) {
+            return Token::close;
+        }
+        while (pos < s.size() && s[pos] == ',') {
+            ++pos;
+        }
+        if (pos == s.size()) {
+            return Token::end;
+        }
+        switch (s[pos]) {
+            case '[':
+                return Token::open;
+            case ']':
+                return Token::close;
+            default:
+                return Token::number;
         }
     }
 
-    std::ostream& print(std::ostream& stream, int depth = 0)
+    // Consumes the peeked bracket
+    void skip()
     {
-        if (v.has_value()) {
-            stream << *v;
+        if (virtualCloses > 0) {
+            --virtualCloses;
         } else {
-            stream << "[";
-            if (nodes.size() > 1) {
-                for (size_t i = 0; i < nodes.size() - 1; ++i) {
-                    nodes[i]->print(stream, depth + 1);
-                    stream << ",";
-                }
-            }
-            if (!nodes.empty()) {
-                nodes.back()->print(stream, depth + 1);
-            }
-            stream << "]";
+            ++pos;
         }
-        return stream;
     }
-};
-
-std::ostream& operator<<(std::ostream& stream, const NodeRef& node)
-{
-    return node->print(stream);
-}
 
-std::optional<bool> compare(const NodeRef& first, const NodeRef& second, int depth = 0)
-{
-    auto _ = gsl::finally([&depth] {
-        if (verbose && depth == 0) {
-            std::cout << std::endl;
+    // Consumes the peeked integer
+    uint32_t number()
+    {
+        uint32_t n{};
+        while (pos < s.size() && s[pos] >= '0' && s[pos] <= '9') {
+            n = 10 * n + static_cast<uint32_t>(s[pos++] - '0');
         }
-    });
+        virtualCloses = promotions;
+        promotions = 0;
+        return n;
+    }
 
-    if (verbose) {
-        std::cout << std::string(2 * depth, ' ') << "- Compare " << first << " vs " << second << std::endl;
+    // Wraps the peeked integer into a list
+    void promote()
+    {
+        ++promotions;
     }
-    if (first->v.has_value() && second->v.has_value()) {
-        if (*first->v < *second->v) {
-            if (verbose) {
-                std::cout << std::string(2 * depth + 2, ' ') << "- Left side is smaller -> true" << std::endl;
-            }
-            return true;
-        }
-        if (*first->v > *second->v) {
-            if (verbose) {
-                std::cout << std::string(2 * depth + 2, ' ') << "- Right side is smaller -> false" << std::endl;
-            }
-            return false;
-        }
-    } else if (!first->v.has_value() && !second->v.has_value()) {
-        for (size_t i = 0; i < first->nodes.size(); ++i) {
-            if (i < second->nodes.size()) {
-                if (auto cmp = compare(first->nodes[i], second->nodes[i], depth + 1); cmp.has_value()) {
-                    return *cmp;
-                }
+
+private:
+    std::string_view s;
+    size_t pos{0};
+    uint32_t promotions{0};
+    uint32_t virtualCloses{0};
+};
+
+// Walks both packets in lockstep, returns a negative value if first is in the right order before second
+static int compare(std::string_view first, std::string_view second)
+{
+    Cursor l{first};
+    Cursor r{second};
+    while (true) {
+        const auto tl{l.peek()};
+        const auto tr{r.peek()};
+        if (tl == tr) {
+            if (tl == Token::end) {
+                return 0;
             }
-            if (i >= second->nodes.size()) {
-                if (verbose) {
-                    std::cout << std::string(2 * depth + 2, ' ') << "- Right side ran out of items -> false"
-                              << std::endl;
+            if (tl == Token::number) {
+                const auto vl{l.number()};
+                const auto vr{r.number()};
+                if (vl != vr) {
+                    return vl < vr ? -1 : 1;
                 }
-                return false;
+            } else {
+                l.skip();
+                r.skip();
             }
+            continue;
         }
-        if (first->nodes.size() < second->nodes.size()) {
-            if (verbose) {
-                std::cout << std::string(2 * depth + 2, ' ') << "- Left side ran out of items -> true" << std::endl;
-            }
-            return true;
+        if (tl == Token::close || tl == Token::end) {
+            // Left side ran out of items
+            return -1;
         }
-    } else {
-        if (verbose) {
-            std::cout << std::string(2 * depth + 2, ' ') << "- Mixed types" << std::endl;
+        if (tr == Token::close || tr == Token::end) {
+            // Right side ran out of items
+            return 1;
         }
-        auto tmp = std::make_shared<Node>();
-        auto next = std::make_shared<Node>();
-        tmp->nodes.push_back(next);
-        if (first->v.has_value()) {
-            next->v = *first->v;
-            if (auto cmp = compare(tmp, second, depth + 1); cmp.has_value()) {
-                return *cmp;
-            }
+        // Mixed types
+        if (tl == Token::number) {
+            l.promote();
+            r.skip();
         } else {
-            next->v = *second->v;
-            if (auto cmp = compare(first, tmp, depth + 1); cmp.has_value()) {
-                return *cmp;
-            }
+            r.promote();
+            l.skip();
         }
     }
-    return std::nullopt;
+}
+
+// The first integer or empty list after the leading brackets decides the order whenever it differs
+static uint32_t sortKey(std::string_view s)
+{
+    Cursor c{s};
+    while (c.peek() == Token::open) {
+        c.skip();
+    }
+    return c.peek() == Token::number ? c.number() + 1 : 0;
+}
+
+// Packet indices in the right order, equal packets keep their relative order
+static std::vector<size_t> sortPackets(const std::vector<std::string_view>& packets)
+{
+    std::vector<uint32_t> keys(packets.size());
+    std::transform(packets.cbegin(), packets.cend(), keys.begin(), [](const auto& packet) { return sortKey(packet); });
+    std::vector<size_t> order(packets.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](const auto a, const auto b) {
+        if (keys[a] != keys[b]) {
+            return keys[a] < keys[b];
+        }
+        const auto cmp{compare(packets[a], packets[b])};
+        return cmp != 0 ? cmp < 0 : a < b;
+    });
+    return order;
 }
 
 int main(int argc, char* argv[])
@@ -178,37 +180,32 @@ int main(int argc, char* argv[])
         }
     }
 
-    std::vector<NodeRef> list{};
-    for (const auto& line : lines) {
+    std::vector<std::string> packets{};
+    for (auto& line : lines) {
         if (!line.empty()) {
-            list.emplace_back(std::make_shared<Node>(line));
+            packets.push_back(std::move(line));
         }
     }
+    if (packets.size() % 2 != 0) {
+        return EXIT_FAILURE;
+    }
 
     {  // Part 1
         size_t count{};
-        for (size_t i = 0; i < list.size(); i += 2) {
-            auto cmp = compare(list[i], list[i + 1]);
-            assert(cmp.has_value());
-            if (*cmp) {
+        for (size_t i = 0; i < packets.size(); i += 2) {
+            if (compare(packets[i], packets[i + 1]) < 0) {
                 count += i / 2 + 1;
             }
         }
         std::cout << count << std::endl;
     }
     {  // Part 2
-        size_t first{};
-        size_t second{1};
-        const auto node2 = std::make_shared<Node>("[[2]]");
-        const auto node6 = std::make_shared<Node>("[[6]]");
-        for (const auto& node : list) {
-            if (auto cmp = compare(node, node2); cmp.has_value() && *cmp) {
-                ++first;
-            }
-            if (auto cmp = compare(node, node6); cmp.has_value() && *cmp) {
-                ++second;
-            }
-        }
+        // Dividers go first such that they precede packets equal to them
+        std::vector<std::string_view> all{"[[2]]", "[[6]]"};
+        all.insert(all.end(), packets.cbegin(), packets.cend());
+        const auto order{sortPackets(all)};
+        const auto first{std::find(order.cbegin(), order.cend(), 0) - order.cbegin()};
+        const auto second{std::find(order.cbegin(), order.cend(), 1) - order.cbegin()};
         std::cout << (first + 1) * (second + 1) << std::endl;
     }
 
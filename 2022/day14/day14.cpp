@@ -4,10 +4,9 @@
 
 #include <algorithm>
 #include <array>
+#include <cstdint>
 #include <fstream>
 #include <iostream>
-#include <memory>
-#include <numeric>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -32,84 +31,118 @@ static bool readFile(std::string fileName, std::vector<std::string>& lines)
 constexpr char air{'.'};
 constexpr char sand{'o'};
 constexpr char rock{'#'};
-constexpr size_t dim{1000};
-using Map = std::array<std::array<char, dim>, dim>;
+constexpr int64_t sourceX{500};
 
-size_t toMap(const std::vector<std::string>& lines, std::unique_ptr<Map>& pmap)
-{
-    auto& map = *pmap;
-    size_t ymax{0};
-    for (auto& row : map) {
-        std::fill_n(row.begin(), row.size(), air);
-    }
+using Point = std::array<int64_t, 2>;
+using Path = std::vector<Point>;
 
-    for (const auto& line : lines) {
-        std::istringstream iss{line};
-        size_t x, y;
-        char c;
-        std::vector<std::array<size_t, 2> > pos{};
-        while (iss >> x >> c >> y) {
-            pos.push_back({x, y});
-            iss.ignore(4);
-            ymax = std::max<size_t>(y, ymax);
+// Cave bounded by the rock paths and the source with one column of air on either side, cells are stored row-major
+class Cave
+{
+public:
+    explicit Cave(const std::vector<Path>& paths)
+    {
+        int64_t xmax{sourceX};
+        for (const auto& path : paths) {
+            for (const auto& [x, y] : path) {
+                xmin = std::min(xmin, x);
+                xmax = std::max(xmax, x);
+                ymax = std::max(ymax, y);
+            }
         }
-        for (size_t i = 0; i < pos.size() - 1; ++i) {
-            auto& [x1, y1] = pos[i];
-            auto& [x2, y2] = pos[i + 1];
-            if (y1 < y2) {
-                for (size_t y = y1; y <= y2; ++y) {
-                    map[x1][y] = rock;
-                }
-            } else if (y2 < y1) {
-                for (size_t y = y2; y <= y1; ++y) {
-                    map[x1][y] = rock;
-                }
-            } else if (x1 < x2) {
-                for (size_t x = x1; x <= x2; ++x) {
-                    map[x][y1] = rock;
-                }
-            } else if (x2 < x1) {
-                for (size_t x = x2; x <= x1; ++x) {
-                    map[x][y1] = rock;
+        xmin -= 1;
+        width = xmax + 2 - xmin;
+        cells.assign(static_cast<size_t>(width * (ymax + 1)), air);
+        for (const auto& path : paths) {
+            for (size_t i = 0; i + 1 < path.size(); ++i) {
+                const auto& [x1, y1] = path[i];
+                const auto& [x2, y2] = path[i + 1];
+                for (auto y = std::min(y1, y2); y <= std::max(y1, y2); ++y) {
+                    for (auto x = std::min(x1, x2); x <= std::max(x1, x2); ++x) {
+                        cells[index(x, y)] = rock;
+                    }
                 }
             }
         }
     }
-    return ymax;
-}
 
-size_t simulate(std::unique_ptr<Map>& pmap, size_t ymax)
+    // Cells beyond the bounds are air
+    char at(int64_t x, int64_t y) const
+    {
+        if (x < xmin || x >= xmin + width || y < 0 || y > ymax) {
+            return air;
+        }
+        return cells[index(x, y)];
+    }
+
+    void set(int64_t x, int64_t y, char c)
+    {
+        cells[index(x, y)] = c;
+    }
+
+    int64_t bottom() const
+    {
+        return ymax;
+    }
+
+private:
+    size_t index(int64_t x, int64_t y) const
+    {
+        return static_cast<size_t>(y * width + x - xmin);
+    }
+
+    int64_t xmin{sourceX};
+    int64_t ymax{0};
+    int64_t width{};
+    std::vector<char> cells{};
+};
+
+// Sand units coming to rest before the first one falls into the abyss, each unit continues from the last free
+// position of the path of its predecessor, since everything above that position is unchanged
+static size_t pour(Cave& cave)
 {
-    auto& map = *pmap;
-    size_t round{};
-    bool done{false};
-    while (!done) {
-        size_t x{500};
-        size_t y{0};
-        do {
-            y++;
-            if (map[x][y] == air) {
-                continue;
-            }
-            if (map[x - 1][y] == air) {
-                x--;
-                continue;
-            }
-            if (map[x + 1][y] == air) {
-                x++;
-                continue;
-            }
-            done = --y == 0;
-            break;
-        } while (y < ymax);
-        if (y >= ymax) {
-            done = true;
+    size_t count{};
+    std::vector<Point> path{{sourceX, 0}};
+    while (!path.empty()) {
+        const auto [x, y] = path.back();
+        if (y >= cave.bottom()) {
             break;
         }
-        map[x][y] = sand;
-        round++;
+        if (cave.at(x, y + 1) == air) {
+            path.push_back({x, y + 1});
+        } else if (cave.at(x - 1, y + 1) == air) {
+            path.push_back({x - 1, y + 1});
+        } else if (cave.at(x + 1, y + 1) == air) {
+            path.push_back({x + 1, y + 1});
+        } else {
+            cave.set(x, y, sand);
+            count++;
+            path.pop_back();
+        }
+    }
+    return count;
+}
+
+// Sand units coming to rest on the floor two rows below the lowest rock until the source is blocked, which are
+// exactly the cells reachable from the source, swept row by row in O(area)
+static size_t fill(const Cave& cave)
+{
+    const auto floor{cave.bottom() + 2};
+    // Row y can only be reached within sourceX - y to sourceX + y
+    const auto offset{sourceX - floor};
+    std::vector<char> cur(static_cast<size_t>(2 * floor + 3), 0);
+    std::vector<char> next(cur.size(), 0);
+    cur[static_cast<size_t>(sourceX - offset)] = 1;
+    size_t count{1};
+    for (int64_t y = 1; y < floor; ++y) {
+        for (auto x = sourceX - y; x <= sourceX + y; ++x) {
+            const auto i{static_cast<size_t>(x - offset)};
+            next[i] = cave.at(x, y) != rock && (cur[i - 1] || cur[i] || cur[i + 1]);
+            count += next[i];
+        }
+        std::swap(cur, next);
     }
-    return round;
+    return count;
 }
 
 int main(int argc, char* argv[])
@@ -121,22 +154,25 @@ int main(int argc, char* argv[])
         }
     }
 
-    auto pmap = std::make_unique<Map>();
-    auto ymax = toMap(lines, pmap);
-    size_t round{};
+    std::vector<Path> paths{};
+    for (const auto& line : lines) {
+        std::istringstream iss{line};
+        int64_t x, y;
+        char c;
+        Path path{};
+        while (iss >> x >> c >> y) {
+            path.push_back({x, y});
+            iss.ignore(4);
+        }
+        paths.push_back(std::move(path));
+    }
+    Cave cave{paths};
 
     {  // Part 1
-        round += simulate(pmap, ymax);
-        std::cout << round << std::endl;
+        std::cout << pour(cave) << std::endl;
     }
     {  // Part 2
-        ymax += 2;
-        auto& map = *pmap;
-        for (size_t x = 0; x < dim; ++x) {
-            map[x][ymax] = rock;
-        }
-        round += simulate(pmap, ymax);
-        std::cout << round << std::endl;
+        std::cout << fill(cave) << std::endl;
     }
     return EXIT_SUCCESS;
 }
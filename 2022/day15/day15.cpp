@@ -4,12 +4,14 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <fstream>
 #include <iostream>
-#include <numeric>
+#include <optional>
 #include <set>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include <gsl/util>
@@ -46,95 +48,179 @@ inline Pos rotateAndScaleInv(const Pos& pos)
     return Pos{(pos[0] + pos[1]) / 2, (-pos[0] + pos[1]) / 2};
 }
 
-int main(int argc, char* argv[])
+struct Sensor
 {
-    std::vector<std::string> lines{};
-    if (argc == 2) {
-        if (!readFile(argv[1], lines)) {
-            return EXIT_FAILURE;
+    Pos pos;
+    Pos beacon;
+    int64_t range;
+};
+
+using Sensors = std::vector<Sensor>;
+// Closed x interval
+using Interval = std::array<int64_t, 2>;
+
+// Sorted and merged intervals covered in row y in O(s log s), touching intervals are merged, too
+static void coverage(const Sensors& sensors, int64_t y, std::vector<Interval>& intervals)
+{
+    intervals.clear();
+    for (const auto& sensor : sensors) {
+        if (const auto d{sensor.range - std::abs(sensor.pos[1] - y)}; d >= 0) {
+            intervals.push_back({sensor.pos[0] - d, sensor.pos[0] + d});
+        }
+    }
+    std::sort(intervals.begin(), intervals.end());
+    size_t n{0};
+    for (size_t i = 0; i < intervals.size(); ++i) {
+        if (n > 0 && intervals[i][0] <= intervals[n - 1][1] + 1) {
+            intervals[n - 1][1] = std::max(intervals[n - 1][1], intervals[i][1]);
+        } else {
+            intervals[n++] = intervals[i];
         }
     }
+    intervals.resize(n);
+}
 
-    {  // Part 1
-        const int64_t y{2000000};
-        std::vector<Pos> intervals{};
-        std::set<int64_t> xbs{};
-        for (const auto& line : lines) {
-            std::istringstream iss{line.substr(12, line.size() - 12)};
-            int64_t xs, ys, xb, yb;
-            iss >> xs;
-            iss.ignore(4);
-            iss >> ys;
-            iss.ignore(25);
-            iss >> xb;
-            iss.ignore(4);
-            iss >> yb;
-            if (yb == y) {
-                xbs.insert(xb);
-            }
-            if (int64_t d{manhattanDistance({xs, ys}, {xb, yb}) - std::abs(ys - y)}; d >= 0) {
-                intervals.emplace_back(Pos{xs - d, xs + d});
-            }
+// Positions in row y where no beacon can be
+static int64_t countExcluded(const Sensors& sensors, int64_t y)
+{
+    std::vector<Interval> intervals{};
+    coverage(sensors, y, intervals);
+    int64_t count{};
+    for (const auto& [xmin, xmax] : intervals) {
+        count += xmax - xmin + 1;
+    }
+    std::set<int64_t> xbs{};
+    for (const auto& sensor : sensors) {
+        if (sensor.beacon[1] == y) {
+            xbs.insert(sensor.beacon[0]);
         }
+    }
+    return count - static_cast<int64_t>(xbs.size());
+}
+
+static bool isCovered(const Sensors& sensors, const Pos& pos)
+{
+    return std::any_of(sensors.cbegin(), sensors.cend(),
+                       [&pos](const auto& sensor) { return manhattanDistance(sensor.pos, pos) <= sensor.range; });
+}
 
-        std::set<int64_t> xs{};
-        for (const auto& [xmin, xmax] : intervals) {
-            for (int64_t x = xmin; x <= xmax; ++x) {
-                xs.insert(x);
+// Idea: Make use of AABB in rotated and scaled CS, where two sensors that leave a gap of exactly one position
+// between their AABBs determine a diagonal line the uncovered position must lie on
+static std::optional<Pos> findByDiagonals(const Sensors& sensors, int64_t max)
+{
+    std::set<int64_t> us{};
+    std::set<int64_t> vs{};
+    for (size_t i = 0; i < sensors.size(); ++i) {
+        const auto si{rotateAndScale(sensors[i].pos)};
+        for (size_t j = 0; j < sensors.size(); ++j) {
+            const auto sj{rotateAndScale(sensors[j].pos)};
+            const auto gap{sensors[i].range + sensors[j].range + 2};
+            if (sj[0] - si[0] == gap) {
+                us.insert(si[0] + sensors[i].range + 1);
+            }
+            if (sj[1] - si[1] == gap) {
+                vs.insert(si[1] + sensors[i].range + 1);
             }
         }
-        std::cout << xs.size() - xbs.size() << std::endl;
     }
-    {  // Part 2
-        // Idea: Make use of AABB in rotated and scaled CS
-        std::vector<std::pair<Pos, Pos> > aabbs{};
-        for (const auto& line : lines) {
-            std::istringstream iss{line.substr(12, line.size() - 12)};
-            int64_t xs, ys, xb, yb;
-            iss >> xs;
-            iss.ignore(4);
-            iss >> ys;
-            iss.ignore(25);
-            iss >> xb;
-            iss.ignore(4);
-            iss >> yb;
-            auto d{manhattanDistance({xs, ys}, {xb, yb})};
-            Pos s{rotateAndScale({xs, ys})};
-            aabbs.push_back(std::make_pair(Pos{s[0] - d, s[1] - d}, Pos{s[0] + d, s[1] + d}));
+    for (const auto u : us) {
+        for (const auto v : vs) {
+            if ((u + v) % 2 != 0) {
+                continue;
+            }
+            const Pos p{rotateAndScaleInv({u, v})};
+            if (p[0] < 0 || p[1] < 0 || p[0] > max || p[1] > max) {
+                continue;
+            }
+            if (!isCovered(sensors, p)) {
+                return p;
+            }
         }
-        // The *one* non-intersected pos must be found on the border of an AABB.
-        for (size_t i = 0; i < aabbs.size(); ++i) {
-            const auto& [pi1, pi2] = aabbs[i];
-            std::array<std::pair<Pos, Pos>, 4> borders{};
-            borders[0] = std::make_pair(Pos{pi1[0] - 1, pi1[0] - 1}, Pos{pi1[1], pi2[1]});
-            borders[1] = std::make_pair(Pos{pi2[0] + 1, pi2[0] + 1}, Pos{pi1[1], pi2[1]});
-            borders[2] = std::make_pair(Pos{pi1[0], pi2[0]}, Pos{pi1[1] - 1, pi1[1] - 1});
-            borders[3] = std::make_pair(Pos{pi1[0], pi2[0]}, Pos{pi2[1] + 1, pi2[1] + 1});
-            for (const auto& [px, py] : borders) {
-                for (int64_t x = px[0]; x <= px[1]; ++x) {
-                    for (int64_t y = py[0]; y <= py[1]; ++y) {
-                        const Pos p{rotateAndScaleInv({x, y})};
-                        if (p[0] < 0 || p[1] < 0 || p[0] > 4000000 || p[1] > 4000000) {
-                            continue;
-                        }
-                        bool overlap{false};
-                        for (size_t j = 0; j < aabbs.size(); ++j) {
-                            if (i == j) {
-                                continue;
-                            }
-                            const auto& [pj1, pj2] = aabbs[j];
-                            if (pj1[0] <= x && x <= pj2[0] && pj1[1] <= y && y <= pj2[1]) {
-                                overlap = true;
-                                break;
-                            }
-                        }
-                        if (!overlap) {
-                            std::cout << p[0] * 4000000 + p[1] << std::endl;
-                            return EXIT_SUCCESS;
+    }
+    return std::nullopt;
+}
+
+// Scans the rows for the first uncovered position in parallel, used if the position is not between two AABBs
+static std::optional<Pos> findByRows(const Sensors& sensors, int64_t max)
+{
+    constexpr int64_t rowsPerBlock{4096};
+    const auto blocks{static_cast<size_t>(max / rowsPerBlock + 1)};
+    std::atomic<size_t> next{0};
+    std::atomic<int64_t> found{-1};
+    std::vector<std::optional<Pos> > results(blocks);
+    std::vector<std::thread> workers{};
+    const auto threads{std::max<size_t>(1, std::min<size_t>(std::thread::hardware_concurrency(), blocks))};
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&] {
+            std::vector<Interval> intervals{};
+            for (auto b = next++; b < blocks && found < 0; b = next++) {
+                const auto first{static_cast<int64_t>(b) * rowsPerBlock};
+                for (auto y = first; y <= std::min(max, first + rowsPerBlock - 1); ++y) {
+                    coverage(sensors, y, intervals);
+                    int64_t x{0};
+                    for (const auto& [xmin, xmax] : intervals) {
+                        if (xmin > x) {
+                            break;
                         }
+                        x = std::max(x, xmax + 1);
+                    }
+                    if (x <= max) {
+                        results[b] = Pos{x, y};
+                        found = 1;
+                        break;
                     }
                 }
             }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    for (const auto& result : results) {
+        if (result) {
+            return result;
+        }
+    }
+    return std::nullopt;
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<std::string> lines{};
+    if (argc == 2) {
+        if (!readFile(argv[1], lines)) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    Sensors sensors{};
+    for (const auto& line : lines) {
+        if (line.size() < 12) {
+            continue;
+        }
+        std::istringstream iss{line.substr(12, line.size() - 12)};
+        int64_t xs, ys, xb, yb;
+        iss >> xs;
+        iss.ignore(4);
+        iss >> ys;
+        iss.ignore(25);
+        iss >> xb;
+        iss.ignore(4);
+        iss >> yb;
+        sensors.push_back({{xs, ys}, {xb, yb}, manhattanDistance({xs, ys}, {xb, yb})});
+    }
+
+    {  // Part 1
+        std::cout << countExcluded(sensors, 2000000) << std::endl;
+    }
+    {  // Part 2
+        const int64_t max{4000000};
+        auto p{findByDiagonals(sensors, max)};
+        if (!p) {
+            p = findByRows(sensors, max);
+        }
+        if (p) {
+            std::cout << (*p)[0] * 4000000 + (*p)[1] << std::endl;
         }
     }
 
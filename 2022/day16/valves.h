@@ -0,0 +1,171 @@
+// Valve network compressed to the valves with non-zero flow rate
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+constexpr uint16_t unreachable{UINT16_MAX / 2};
+
+struct Valves
+{
+    // Names and flow rates of the useful valves, bit i of a mask stands for valve i
+    std::vector<std::string> names{};
+    std::vector<uint16_t> rates{};
+    // Shortest distances between the useful valves, the start valve is appended as last index
+    std::vector<std::vector<uint16_t> > dists{};
+
+    size_t size() const
+    {
+        return rates.size();
+    }
+
+    size_t start() const
+    {
+        return rates.size();
+    }
+};
+
+// Parses the scan output and reduces the network by Floyd-Warshall distances over all valves
+inline Valves compress(const std::vector<std::string>& lines, const std::string& startName = "AA")
+{
+    std::vector<std::string> names{};
+    std::vector<uint16_t> rates{};
+    std::vector<std::vector<std::string> > tunnels{};
+    for (const auto& line : lines) {
+        if (line.size() < 6) {
+            continue;
+        }
+        std::istringstream iss{line.substr(6, line.size() - 6)};
+        std::string first, second;
+        iss >> first;
+        iss.ignore(15);
+        uint32_t rate;
+        iss >> rate;
+        iss.ignore(24);
+        names.push_back(first);
+        rates.push_back(static_cast<uint16_t>(rate));
+        tunnels.emplace_back();
+        while (iss >> second) {
+            if (second[second.size() - 1] == ',') {
+                second = second.substr(0, second.size() - 1);
+            }
+            tunnels.back().push_back(second);
+        }
+    }
+
+    const auto n{names.size()};
+    const auto index = [&names](const std::string& name) {
+        return static_cast<size_t>(std::find(names.cbegin(), names.cend(), name) - names.cbegin());
+    };
+    std::vector<std::vector<uint16_t> > dists(n, std::vector<uint16_t>(n, unreachable));
+    for (size_t i = 0; i < n; ++i) {
+        dists[i][i] = 0;
+        for (const auto& tunnel : tunnels[i]) {
+            if (const auto j{index(tunnel)}; j < n) {
+                dists[i][j] = 1;
+            }
+        }
+    }
+    for (size_t k = 0; k < n; ++k) {
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < n; ++j) {
+                dists[i][j] = std::min<uint16_t>(dists[i][j], dists[i][k] + dists[k][j]);
+            }
+        }
+    }
+
+    std::vector<size_t> useful{};
+    for (size_t i = 0; i < n; ++i) {
+        if (rates[i] > 0) {
+            useful.push_back(i);
+        }
+    }
+    useful.push_back(index(startName));
+
+    Valves valves{};
+    for (size_t i = 0; i < useful.size() - 1; ++i) {
+        valves.names.push_back(names[useful[i]]);
+        valves.rates.push_back(rates[useful[i]]);
+    }
+    for (const auto& i : useful) {
+        valves.dists.emplace_back();
+        for (const auto& j : useful) {
+            valves.dists.back().push_back(i < n && j < n ? dists[i][j] : unreachable);
+        }
+    }
+    return valves;
+}
+
+// Best pressure released when opening the valves of each mask within the given time, exact only once combined by
+// subsetMax: a frame is skipped if the same valves were already opened ending at the same valve with no less time left
+// and no less pressure, or if opening every remaining valve right away cannot beat the best of its own mask, which
+// every superset mask includes after subsetMax
+inline std::vector<uint32_t> bestPerMask(const Valves& valves, uint16_t time)
+{
+    const auto n{valves.size()};
+    std::vector<uint32_t> best(size_t{1} << n, 0);
+    struct Frame
+    {
+        size_t pos;
+        uint16_t time;
+        uint32_t mask;
+        uint32_t pressure;
+    };
+    struct Seen
+    {
+        uint32_t pressure;
+        uint16_t time;
+    };
+    std::vector<Seen> seen(n << n, Seen{0, 0});
+    std::vector<Frame> stack{{valves.start(), time, 0, 0}};
+    while (!stack.empty()) {
+        const auto [pos, timeLeft, mask, pressure] = stack.back();
+        stack.pop_back();
+        uint32_t bound{pressure};
+        for (size_t j = 0; j < n; ++j) {
+            if (!(mask & (uint32_t{1} << j)) && valves.dists[pos][j] + 1 < timeLeft) {
+                bound += (timeLeft - valves.dists[pos][j] - 1) * valves.rates[j];
+            }
+        }
+        if (bound <= best[mask]) {
+            continue;
+        }
+        best[mask] = std::max(best[mask], pressure);
+        for (size_t j = 0; j < n; ++j) {
+            if (mask & (uint32_t{1} << j)) {
+                continue;
+            }
+            // Walk there and open the valve
+            const auto cost{valves.dists[pos][j] + 1};
+            if (cost >= timeLeft) {
+                continue;
+            }
+            const auto left{static_cast<uint16_t>(timeLeft - cost)};
+            const auto nextMask{mask | (uint32_t{1} << j)};
+            const auto nextPressure{pressure + left * valves.rates[j]};
+            auto& s = seen[nextMask * n + j];
+            if (s.time >= left && s.pressure >= nextPressure) {
+                continue;
+            }
+            s = {nextPressure, left};
+            stack.push_back({j, left, nextMask, nextPressure});
+        }
+    }
+    return best;
+}
+
+// Sum over subsets transform turning the best per mask into the best over all of its subsets
+inline void subsetMax(std::vector<uint32_t>& best, size_t bits)
+{
+    for (size_t i = 0; i < bits; ++i) {
+        for (size_t mask = 0; mask < best.size(); ++mask) {
+            if (mask & (size_t{1} << i)) {
+                best[mask] = std::max(best[mask], best[mask ^ (size_t{1} << i)]);
+            }
+        }
+    }
+}
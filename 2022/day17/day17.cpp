@@ -3,12 +3,10 @@
 // https://adventofcode.com/2022/day/17
 
 #include <algorithm>
-#include <assert.h>
+#include <array>
+#include <cstdint>
 #include <fstream>
 #include <iostream>
-#include <map>
-#include <numeric>
-#include <set>
 #include <string>
 #include <vector>
 
@@ -29,200 +27,151 @@ static bool readFile(std::string fileName, std::vector<std::string>& lines)
     return true;
 }
 
-constexpr char p1{'-'};
-constexpr char p2{'+'};
-constexpr char p3{'L'};
-constexpr char p4{'|'};
-constexpr char p5{'#'};
-constexpr std::array<char, 5> parts{p1, p2, p3, p4, p5};
 constexpr char left{'<'};
 constexpr char right{'>'};
-constexpr char down{'v'};
-constexpr uint64_t width{7};
+constexpr size_t rockCount{5};
+// Rocks as four packed row bytes from bottom to top, bit x stands for column x, spawned two units from the left wall
+constexpr std::array<uint32_t, rockCount> rocks{
+    0x0000003C,  // -
+    0x00081C08,  // +
+    0x0010101C,  // L
+    0x04040404,  // |
+    0x00000C0C,  // #
+};
+constexpr std::array<int64_t, rockCount> rockHeights{1, 3, 3, 4, 2};
+constexpr uint32_t leftWall{0x01010101};
+constexpr uint32_t rightWall{0x40404040};
+constexpr uint8_t fullRow{0x7F};
+// Rows kept below the top of the tower, rocks are assumed to never sink deeper
+constexpr size_t ringSize{size_t{1} << 16};
+// Rows at the top of the tower that identify a repeating state
+constexpr size_t topRows{64};
 
-using Pos = std::array<uint64_t, 2>;
-using Map = std::vector<Pos>;
-using Cache = std::map<std::pair<size_t, std::set<Pos> >, std::pair<uint64_t, uint64_t> >;
-using Caches = std::array<Cache, 5>;
+// Chamber as ring buffer of 7-bit row bytes, such that collision is a bitwise AND of packed rows
+class Chamber
+{
+public:
+    explicit Chamber(const std::string& jets) : jets{jets}, rows(ringSize, 0)
+    {
+    }
 
-Caches caches{};
-Map map{};
+    void drop()
+    {
+        auto rock{rocks[rockIndex]};
+        while (cleared < top + 3 + 4) {
+            rows[cleared++ & (ringSize - 1)] = 0;
+        }
+        // The first four pushes happen above the tower, where only the walls can block
+        for (size_t i = 0; i < 4; ++i) {
+            rock = push(rock);
+        }
+        auto y{top};
+        while (y > 0 && fits(rock, y - 1)) {
+            --y;
+            if (const auto pushed{push(rock)}; fits(pushed, y)) {
+                rock = pushed;
+            }
+        }
+        for (int64_t i = 0; i < rockHeights[rockIndex]; ++i) {
+            rows[(y + i) & (ringSize - 1)] |= static_cast<uint8_t>(rock >> (8 * i));
+        }
+        top = std::max(top, y + rockHeights[rockIndex]);
+        rockIndex = (rockIndex + 1) % rockCount;
+    }
 
-inline Pos create(uint64_t y)
-{
-    if (!map.empty()) {
-        return {2, y + 4};
+    uint64_t height() const
+    {
+        return static_cast<uint64_t>(top);
     }
-    return {2, 3};
-}
 
-inline bool isFree(const Pos& pos)
-{
-    return std::find(map.cbegin(), map.cend(), pos) == map.cend();
-}
+    // Index of the next jet and rock
+    size_t state() const
+    {
+        return jetIndex * rockCount + rockIndex;
+    }
 
-bool tryMove(char dir, char part, Pos& pos)
-{
-    auto& [x, y] = pos;
-    switch (part) {
-        case p1:
-            switch (dir) {
-                case right:
-                    if (x < width - 4 && isFree({x + 4, y})) {
-                        x++;
-                        return true;
-                    }
-                    break;
-                case left:
-                    if (x > 0 && isFree({x - 1, y})) {
-                        x--;
-                        return true;
-                    }
-                    break;
-                default:
-                    if (y > 0 && isFree({x, y - 1}) && isFree({x + 1, y - 1}) && isFree({x + 2, y - 1}) &&
-                        isFree({x + 3, y - 1})) {
-                        y--;
-                        return true;
-                    }
-                    break;
-            }
-            break;
-        case p2:
-            switch (dir) {
-                case right:
-                    if (x < width - 3 && isFree({x + 2, y}) && isFree({x + 3, y + 1}) && isFree({x + 2, y + 2})) {
-                        x++;
-                        return true;
-                    }
-                    break;
-                case left:
-                    if (x > 0 && isFree({x, y}) && isFree({x - 1, y + 1}) && isFree({x, y + 2})) {
-                        x--;
-                        return true;
-                    }
-                    break;
-                default:
-                    if (y > 0 && isFree({x, y}) && isFree({x + 1, y - 1}) && isFree({x + 2, y})) {
-                        y--;
-                        return true;
-                    }
-                    break;
+    uint64_t topHash() const
+    {
+        uint64_t hash{topRows};
+        for (size_t i = 0; i < topRows; i += 8) {
+            uint64_t word{};
+            for (size_t j = 0; j < 8; ++j) {
+                word |= uint64_t{row(top - 1 - static_cast<int64_t>(i + j))} << (8 * j);
             }
-            break;
-        case p3:
-            switch (dir) {
-                case right:
-                    if (x < width - 3 && isFree({x + 3, y}) && isFree({x + 3, y + 1}) && isFree({x + 3, y + 2})) {
-                        x++;
-                        return true;
-                    }
-                    break;
-                case left:
-                    if (x > 0 && isFree({x - 1, y}) && isFree({x + 1, y + 1}) && isFree({x + 1, y + 2})) {
-                        x--;
-                        return true;
-                    }
-                    break;
-                default:
-                    if (y > 0 && isFree({x, y - 1}) && isFree({x + 1, y - 1}) && isFree({x + 2, y - 1})) {
-                        y--;
-                        return true;
-                    }
-                    break;
-            }
-            break;
-        case p4:
-            switch (dir) {
-                case right:
-                    if (x < width - 1 && isFree({x + 1, y}) && isFree({x + 1, y + 1}) && isFree({x + 1, y + 2}) &&
-                        isFree({x + 1, y + 3})) {
-                        x++;
-                        return true;
-                    }
-                    break;
-                case left:
-                    if (x > 0 && isFree({x - 1, y}) && isFree({x - 1, y + 1}) && isFree({x - 1, y + 2}) &&
-                        isFree({x - 1, y + 3})) {
-                        x--;
-                        return true;
-                    }
-                    break;
-                default:
-                    if (y > 0 && isFree({x, y - 1})) {
-                        y--;
-                        return true;
-                    }
-                    break;
-            }
-            break;
-        case p5:
-            switch (dir) {
-                case right:
-                    if (x < width - 2 && isFree({x + 2, y}) && isFree({x + 2, y + 1})) {
-                        x++;
-                        return true;
-                    }
-                    break;
-                case left:
-                    if (x > 0 && isFree({x - 1, y}) && isFree({x - 1, y + 1})) {
-                        x--;
-                        return true;
-                    }
-                    break;
-                default:
-                    if (y > 0 && isFree({x, y - 1}) && isFree({x + 1, y - 1})) {
-                        y--;
-                        return true;
-                    }
-                    break;
-            }
-            break;
-        default:
-            break;
+            hash ^= word + 0x9e3779b97f4a7c15 + (hash << 6) + (hash >> 2);
+        }
+        return hash;
+    }
+
+private:
+    uint8_t row(int64_t y) const
+    {
+        if (y < 0 || y + static_cast<int64_t>(ringSize) <= top) {
+            return fullRow;
+        }
+        return rows[y & (ringSize - 1)];
+    }
+
+    bool fits(uint32_t rock, int64_t y) const
+    {
+        uint32_t packed{};
+        for (int64_t i = 0; i < 4; ++i) {
+            packed |= uint32_t{row(y + i)} << (8 * i);
+        }
+        return (rock & packed) == 0;
+    }
+
+    // Rock pushed by the next jet as far as the walls allow
+    uint32_t push(uint32_t rock)
+    {
+        const auto jet{jets[jetIndex]};
+        jetIndex = (jetIndex + 1) % jets.size();
+        if (jet == left) {
+            return (rock & leftWall) == 0 ? rock >> 1 : rock;
+        }
+        return (rock & rightWall) == 0 ? rock << 1 : rock;
     }
-    return false;
-}
 
-uint64_t rest(char part, const Pos& pos, uint64_t maxY)
+    const std::string& jets;
+    std::vector<uint8_t> rows;
+    int64_t top{0};
+    int64_t cleared{0};
+    size_t jetIndex{0};
+    size_t rockIndex{0};
+};
+
+// Tower height after the given rocks, extrapolated over whole cycles as soon as a state repeats
+static uint64_t towerHeight(const std::string& jets, uint64_t count)
 {
-    const auto& [x, y] = pos;
-    switch (part) {
-        case p1:
-            map.push_back(pos);
-            map.push_back({x + 1, y});
-            map.push_back({x + 2, y});
-            map.push_back({x + 3, y});
-            return std::max<uint64_t>(maxY, y);
-        case p2:
-            map.push_back({x + 1, y});
-            map.push_back({x, y + 1});
-            map.push_back({x + 1, y + 1});
-            map.push_back({x + 2, y + 1});
-            map.push_back({x + 1, y + 2});
-            return std::max<uint64_t>(maxY, y + 2);
-        case p3:
-            map.push_back(pos);
-            map.push_back({x + 1, y});
-            map.push_back({x + 2, y});
-            map.push_back({x + 2, y + 1});
-            map.push_back({x + 2, y + 2});
-            return std::max<uint64_t>(maxY, y + 2);
-        case p4:
-            map.push_back(pos);
-            map.push_back({x, y + 1});
-            map.push_back({x, y + 2});
-            map.push_back({x, y + 3});
-            return std::max<uint64_t>(maxY, y + 3);
-        case p5:
-            map.push_back(pos);
-            map.push_back({x + 1, y});
-            map.push_back({x, y + 1});
-            map.push_back({x + 1, y + 1});
-            return std::max<uint64_t>(maxY, y + 1);
-        default:
-            return maxY;
+    struct Seen
+    {
+        uint64_t hash;
+        uint64_t rocks;
+        uint64_t height;
+    };
+    std::vector<Seen> seen(jets.size() * rockCount, Seen{0, UINT64_MAX, 0});
+    Chamber chamber{jets};
+    uint64_t dropped{0};
+    uint64_t skippedHeight{0};
+    bool isExtrapolated{false};
+    while (dropped < count) {
+        if (!isExtrapolated && chamber.height() >= topRows) {
+            auto& s = seen[chamber.state()];
+            const auto hash{chamber.topHash()};
+            if (s.rocks != UINT64_MAX && s.hash == hash) {
+                const auto period{dropped - s.rocks};
+                const auto cycles{(count - dropped) / period};
+                skippedHeight = cycles * (chamber.height() - s.height);
+                dropped += cycles * period;
+                isExtrapolated = true;
+                continue;
+            }
+            s = {hash, dropped, chamber.height()};
+        }
+        chamber.drop();
+        ++dropped;
     }
+    return chamber.height() + skippedHeight;
 }
 
 int main(int argc, char* argv[])
@@ -234,61 +183,14 @@ int main(int argc, char* argv[])
         }
     }
 
-    const auto& dirs = lines[0];
-    size_t dirPos{0};
-    uint64_t maxY{};
-    {  // Part 1
-        for (size_t step = 0; step < 2022; ++step) {
-            const auto part = parts[step % 5];
-            auto pos = create(maxY);
-            while (true) {
-                tryMove(dirs[dirPos], part, pos);
-                dirPos = (dirPos + 1) % dirs.size();
-                if (!tryMove(down, part, pos)) {
-                    maxY = rest(part, pos, maxY);
-                    break;
-                }
-            }
-        }
-        std::cout << maxY + 1 << std::endl;
-    }
-    {  // Part 2
-        uint64_t step{2022};
-        const uint64_t stop{1000000000000};
-        uint64_t skippedY{};
-        while (step < stop) {
-            const auto part = parts[step % 5];
-            auto pos = create(maxY);
-            while (true) {
-                tryMove(dirs[dirPos], part, pos);
-                dirPos = (dirPos + 1) % dirs.size();
-                if (!tryMove(down, part, pos)) {
-                    maxY = rest(part, pos, maxY);
-                    std::set<Pos> set{};
-                    for (const auto& [x, y] : map) {
-                        if (maxY - y < 100) {
-                            // Heuristic: Only check for relative y positions within certain relative threshold
-                            set.insert({x, maxY - y});
-                        }
-                    }
-                    auto& cache = caches[step % 5];
-                    auto [it, isInserted] = cache.try_emplace(std::pair(dirPos, set), std::pair(step, maxY));
-                    if (!isInserted) {
-                        // Idea: Check for a repeating pattern given the current dirPos and ordered set of existing parts (with relative y coordinates)
-                        // If found: Determine stepPeriod and number of cycles to skip while still being less than stop
-                        const auto [lastStep, lastMaxY] = it->second;
-                        const auto stepPeriod = step - lastStep;
-                        const auto cyclesToSkip = (stop - step) / stepPeriod;
-                        skippedY += cyclesToSkip * (maxY - lastMaxY);
-                        step = stop - (stop - step) % stepPeriod;
-                    }
-                    break;
-                }
-            }
-            step++;
-        }
-        std::cout << maxY + 1 + skippedY << std::endl;
+    if (lines.empty() || lines[0].empty() ||
+        std::any_of(lines[0].cbegin(), lines[0].cend(), [](const auto c) { return c != left && c != right; })) {
+        return EXIT_FAILURE;
     }
 
+    const auto& jets = lines[0];
+    std::cout << towerHeight(jets, 2022) << std::endl;
+    std::cout << towerHeight(jets, 1000000000000) << std::endl;
+
     return EXIT_SUCCESS;
 }
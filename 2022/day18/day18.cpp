@@ -3,10 +3,11 @@
 // https://adventofcode.com/2022/day/18
 
 #include <algorithm>
+#include <array>
+#include <bitset>
+#include <cstdint>
 #include <fstream>
 #include <iostream>
-#include <numeric>
-#include <queue>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -28,52 +29,164 @@ static bool readFile(std::string fileName, std::vector<std::string>& lines)
     return true;
 }
 
-using Cube = std::array<int16_t, 3>;
+using Cube = std::array<int32_t, 3>;
 using Cubes = std::vector<Cube>;
 
-size_t bfs(const Cubes& cubes, const Cube& mins, const Cube& maxs)
+// Dense bit volume, bit x of row (y, z) is stored in word x / 64 of that row
+class Volume
 {
-    size_t count{};
-    Cubes visited{};
-    std::queue<Cube> q{};
-    q.push(mins);
-    auto isVisited = [&visited](const Cube& cube) {
-        return std::find(visited.crbegin(), visited.crend(), cube) != visited.crend();
-    };
-    auto isLava = [&cubes](const Cube& cube) { return std::find(cubes.cbegin(), cubes.cend(), cube) != cubes.cend(); };
-    auto evalCube = [&](const Cube&& cube) {
-        if (isLava(cube)) {
-            count++;
-        } else if (!isVisited(cube)) {
-            visited.push_back(cube);
-            q.push(cube);
+public:
+    Volume(size_t nx, size_t ny, size_t nz)
+        : nx{nx}, ny{ny}, nz{nz}, words{(nx + 63) / 64}, bits(ny * nz * words, 0)
+    {
+    }
+
+    void set(size_t x, size_t y, size_t z)
+    {
+        row(y, z)[x / 64] |= uint64_t{1} << (x % 64);
+    }
+
+    uint64_t* row(size_t y, size_t z)
+    {
+        return &bits[(z * ny + y) * words];
+    }
+
+    const uint64_t* row(size_t y, size_t z) const
+    {
+        return &bits[(z * ny + y) * words];
+    }
+
+    // Bits of word w that lie within the volume
+    uint64_t domain(size_t w) const
+    {
+        return w + 1 < words || nx % 64 == 0 ? UINT64_MAX : (uint64_t{1} << (nx % 64)) - 1;
+    }
+
+    // Faces between set and unset voxels, the volume must not touch its own boundary
+    size_t surface() const
+    {
+        size_t count{};
+        for (size_t z = 0; z < nz; ++z) {
+            for (size_t y = 0; y < ny; ++y) {
+                const auto* r = row(y, z);
+                for (size_t w = 0; w < words; ++w) {
+                    const auto shifted{(r[w] << 1) | (w > 0 ? r[w - 1] >> 63 : 0)};
+                    count += std::bitset<64>(r[w] ^ shifted).count();
+                    if (y + 1 < ny) {
+                        count += std::bitset<64>(r[w] ^ row(y + 1, z)[w]).count();
+                    }
+                    if (z + 1 < nz) {
+                        count += std::bitset<64>(r[w] ^ row(y, z + 1)[w]).count();
+                    }
+                }
+            }
         }
-    };
+        return count;
+    }
 
-    while (!q.empty()) {
-        auto cube = q.front();
-        q.pop();
-        auto [x, y, z] = cube;
-        if (x > mins[0]) {
-            evalCube({x - 1, y, z});
+    Volume complement() const
+    {
+        Volume c{nx, ny, nz};
+        for (size_t i = 0; i < bits.size(); ++i) {
+            c.bits[i] = ~bits[i] & domain(i % words);
         }
-        if (x < maxs[0]) {
-            evalCube({x + 1, y, z});
+        return c;
+    }
+
+    const size_t nx;
+    const size_t ny;
+    const size_t nz;
+    const size_t words;
+
+private:
+    std::vector<uint64_t> bits;
+};
+
+// Kogge-Stone fill of the seeds along free bits towards higher bits, and back
+static void fillRow(uint64_t* row, const uint64_t* lava, const Volume& v)
+{
+    uint64_t carry{};
+    for (size_t w = 0; w < v.words; ++w) {
+        auto pro{~lava[w] & v.domain(w)};
+        auto gen{(row[w] | carry) & pro};
+        for (size_t s = 1; s < 64; s *= 2) {
+            gen |= pro & (gen << s);
+            pro &= pro << s;
         }
-        if (y > mins[1]) {
-            evalCube({x, y - 1, z});
+        row[w] = gen;
+        carry = gen >> 63;
+    }
+    carry = 0;
+    for (size_t w = v.words; w-- > 0;) {
+        auto pro{~lava[w] & v.domain(w)};
+        auto gen{(row[w] | carry) & pro};
+        for (size_t s = 1; s < 64; s *= 2) {
+            gen |= pro & (gen >> s);
+            pro &= pro >> s;
         }
-        if (y < maxs[1]) {
-            evalCube({x, y + 1, z});
+        row[w] = gen;
+        carry = gen << 63;
+    }
+}
+
+// Dilates plane z of the exterior by its own rows and the adjacent plane, returns whether it grew
+static bool spreadPlane(Volume& outside, const Volume& lava, size_t z, size_t adjacent)
+{
+    bool grown{false};
+    const auto spread = [&](size_t y, size_t neighbor) {
+        auto* r = outside.row(y, z);
+        const auto* n = outside.row(neighbor, z);
+        const auto* a = outside.row(y, adjacent);
+        const auto* l = lava.row(y, z);
+        // Bits are only ever added, so the row grew if and only if its count grew
+        size_t before{};
+        for (size_t w = 0; w < outside.words; ++w) {
+            before += std::bitset<64>(r[w]).count();
+            r[w] |= (n[w] | a[w]) & ~l[w];
+        }
+        fillRow(r, l, outside);
+        size_t after{};
+        for (size_t w = 0; w < outside.words; ++w) {
+            after += std::bitset<64>(r[w]).count();
+        }
+        grown |= after > before;
+    };
+    for (size_t y = 1; y + 1 < outside.ny; ++y) {
+        spread(y, y - 1);
+    }
+    for (size_t y = outside.ny - 1; y-- > 1;) {
+        spread(y, y + 1);
+    }
+    return grown;
+}
+
+// Air reachable from outside the droplet, by alternating plane sweeps until nothing changes
+static Volume exterior(const Volume& lava)
+{
+    Volume outside{lava.nx, lava.ny, lava.nz};
+    for (size_t z = 0; z < lava.nz; ++z) {
+        for (size_t y = 0; y < lava.ny; ++y) {
+            if (z == 0 || z + 1 == lava.nz || y == 0 || y + 1 == lava.ny) {
+                for (size_t x = 0; x < lava.nx; ++x) {
+                    outside.set(x, y, z);
+                }
+            } else {
+                outside.set(0, y, z);
+                outside.set(lava.nx - 1, y, z);
+            }
         }
-        if (z > mins[2]) {
-            evalCube({x, y, z - 1});
+    }
+    bool grown{true};
+    while (grown) {
+        grown = false;
+        for (size_t z = 1; z + 1 < lava.nz; ++z) {
+            grown |= spreadPlane(outside, lava, z, z - 1);
         }
-        if (z < maxs[2]) {
-            evalCube({x, y, z + 1});
+        for (size_t z = lava.nz - 1; z-- > 1;) {
+            grown |= spreadPlane(outside, lava, z, z + 1);
         }
     }
-    return count;
+    return outside;
 }
 
 int main(int argc, char* argv[])
@@ -87,8 +200,11 @@ int main(int argc, char* argv[])
 
     Cubes cubes{};
     for (const auto& line : lines) {
+        if (line.empty()) {
+            continue;
+        }
         std::istringstream iss{line};
-        int16_t x, y, z;
+        int32_t x, y, z;
         iss >> x;
         iss.ignore(1);
         iss >> y;
@@ -96,30 +212,30 @@ int main(int argc, char* argv[])
         iss >> z;
         cubes.emplace_back(Cube{x, y, z});
     }
+    if (cubes.empty()) {
+        return EXIT_FAILURE;
+    }
 
-    int16_t xmin{INT16_MAX}, xmax{INT16_MIN}, ymin{INT16_MAX}, ymax{INT16_MIN}, zmin{INT16_MAX}, zmax{INT16_MIN};
-    {  // Part 1
-        size_t count{6 * cubes.size()};
-        for (size_t i = 0; i < cubes.size(); ++i) {
-            const auto [xi, yi, zi] = cubes[i];
-            xmin = std::min(xmin, xi);
-            ymin = std::min(ymin, yi);
-            zmin = std::min(zmin, zi);
-            xmax = std::max(xmax, xi);
-            ymax = std::max(ymax, yi);
-            zmax = std::max(zmax, zi);
-            for (size_t j = i + 1; j < cubes.size(); ++j) {
-                const auto [xj, yj, zj] = cubes[j];
-                if ((std::abs(xi - xj) + std::abs(yi - yj) + std::abs(zi - zj)) == 1) {
-                    count -= 2;
-                }
-            }
+    Cube mins{INT32_MAX, INT32_MAX, INT32_MAX};
+    Cube maxs{INT32_MIN, INT32_MIN, INT32_MIN};
+    for (const auto& cube : cubes) {
+        for (size_t i = 0; i < 3; ++i) {
+            mins[i] = std::min(mins[i], cube[i]);
+            maxs[i] = std::max(maxs[i], cube[i]);
         }
-        std::cout << count << std::endl;
+    }
+    // One layer of air around the droplet
+    Volume lava{static_cast<size_t>(maxs[0] - mins[0]) + 3, static_cast<size_t>(maxs[1] - mins[1]) + 3,
+                static_cast<size_t>(maxs[2] - mins[2]) + 3};
+    for (const auto& [x, y, z] : cubes) {
+        lava.set(x - mins[0] + 1, y - mins[1] + 1, z - mins[2] + 1);
+    }
+
+    {  // Part 1
+        std::cout << lava.surface() << std::endl;
     }
     {  // Part 2
-        auto count = bfs(cubes, {xmin - 1, ymin - 1, zmin - 1}, {xmax + 1, ymax + 1, zmax + 1});
-        std::cout << count << std::endl;
+        std::cout << exterior(lava).complement().surface() << std::endl;
     }
 
     return EXIT_SUCCESS;
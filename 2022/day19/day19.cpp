@@ -3,14 +3,14 @@
 // https://adventofcode.com/2022/day/19
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <chrono>
 #include <fstream>
 #include <iostream>
-#include <map>
-#include <numeric>
-#include <queue>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include <gsl/util>
@@ -47,117 +47,125 @@ struct BluePrint
 
 using BluePrints = std::vector<BluePrint>;
 
-struct World
+struct State
 {
     Resources resources{};
     Robots robots{1, 0, 0, 0};
-    uint16_t step{};
+    uint16_t timeLeft{};
+};
 
-    uint64_t hash() const
+// Depth-first search over the next robot to build, skipping the minutes spent waiting for its resources
+class GeodeSearch
+{
+public:
+    GeodeSearch(const BluePrint& blueprint) : plans{blueprint.plans}
     {
-        uint64_t hash{};
+        // More robots of a kind than any robot costs of its resource per minute are never useful
         for (uint16_t i = 0; i < 4; ++i) {
-            hash |= static_cast<uint64_t>(resources[i]) << (16 * i);
-            hash |= static_cast<uint64_t>(robots[i]) << (16 * i + 8);
+            for (uint16_t k = 0; k < geo; ++k) {
+                caps[k] = std::max(caps[k], plans[i][k]);
+            }
         }
-        return hash;
+        caps[geo] = UINT16_MAX;
     }
 
-    void update()
+    uint16_t run(uint16_t maxSteps)
     {
-        for (uint16_t i = 0; i < 4; ++i) {
-            resources[i] += robots[i];
-        }
+        best = 0;
+        State state{};
+        state.timeLeft = maxSteps;
+        dfs(state);
+        return best;
     }
 
-    uint16_t maxExpectedGeods(uint16_t maxSteps) const
+private:
+    // Geodes if obsidian robots and geode robots could be built each minute without any ore or clay
+    uint16_t upperBound(const State& state) const
     {
-        auto g = resources[geo];
-        g += (maxSteps - step) * robots[geo];
-        for (uint16_t i = 1; i < maxSteps - step; i += 2) {
-            g += i;
+        uint16_t geods{state.resources[geo]};
+        uint16_t geoRobots{state.robots[geo]};
+        uint16_t obsidian{state.resources[obs]};
+        uint16_t obsRobots{state.robots[obs]};
+        for (auto t = state.timeLeft; t > 0; --t) {
+            const auto canBuild{obsidian >= plans[geo][obs]};
+            obsidian += obsRobots++;
+            geods += geoRobots;
+            if (canBuild) {
+                obsidian -= plans[geo][obs];
+                ++geoRobots;
+            }
         }
-        return g;
+        return geods;
     }
 
-    std::ostream& print(std::ostream& stream) const
+    void dfs(const State& state)
     {
-        stream << step << ": ";
-        stream << "[" << resources[ore] << "," << resources[clay] << "," << resources[obs] << "," << resources[geo]
-               << "], ";
-        stream << "[" << robots[ore] << "," << robots[clay] << "," << robots[obs] << "," << robots[geo] << "]";
-        return stream;
-    }
-};
-
-static std::ostream& operator<<(std::ostream& stream, const World& world)
-{
-    return world.print(stream);
-}
-
-static size_t bfs(const BluePrint& blueprint, uint16_t maxSteps)
-{
-    std::map<uint64_t, uint16_t> visited{};
-    uint16_t maxGeods{};
-    std::queue<World> q{};
-    q.push(std::move(World()));
-    auto pushQ = [&](const World& next) {
-        const auto hash = next.hash();
-        if (visited.find(hash) == visited.cend()) {
-            visited[hash] = next.resources[geo];
-            if (next.resources[geo] > maxGeods) {
-                maxGeods = next.resources[geo];
-            }
-            q.push(std::move(next));
-        }
-    };
-    uint16_t maxOre{};
-    for (uint16_t k = 0; k < 4; ++k) {
-        maxOre = std::max<int16_t>(maxOre, blueprint.plans[k][ore]);
-    }
-    while (!q.empty()) {
-        World world = q.front();
-        q.pop();
-        if (world.step >= maxSteps) {
-            continue;
+        best = std::max<uint16_t>(best, state.resources[geo] + state.robots[geo] * state.timeLeft);
+        if (upperBound(state) <= best) {
+            return;
         }
-        if (world.maxExpectedGeods(maxSteps) <= maxGeods) {
-            continue;
-        }
-        world.step++;
         for (uint16_t j = 4; j > 0; --j) {
-            auto i = j - 1;
+            const uint16_t i = j - 1;
+            if (state.robots[i] >= caps[i]) {
+                continue;
+            }
+            // Minutes to gather the resources plus one to build
+            uint16_t wait{1};
             bool canBuild{true};
-            World next(world);
-            for (uint16_t k = 0; k < 4; ++k) {
-                if (next.resources[k] < blueprint.plans[i][k]) {
+            for (uint16_t k = 0; k < geo; ++k) {
+                if (plans[i][k] <= state.resources[k]) {
+                    continue;
+                }
+                if (state.robots[k] == 0) {
                     canBuild = false;
                     break;
                 }
+                const uint16_t missing = plans[i][k] - state.resources[k];
+                wait = std::max<uint16_t>(wait, (missing + state.robots[k] - 1) / state.robots[k] + 1);
             }
-            bool wantBuild = next.step + (3 - i) < maxSteps;
-            if (canBuild) {
-                if (i == geo) {
-                    wantBuild = true;
-                } else if (i == obs || i == clay) {
-                    wantBuild = next.robots[i] < blueprint.plans[i + 1][i];
-                } else {
-                    wantBuild = next.robots[ore] < maxOre;
-                }
+            if (!canBuild || wait >= state.timeLeft) {
+                continue;
             }
-            if (canBuild && wantBuild) {
-                for (uint16_t k = 0; k < 4; ++k) {
-                    next.resources[k] -= blueprint.plans[i][k];
-                }
-                next.update();
-                next.robots[i]++;
-                pushQ(next);
+            State next{state};
+            next.timeLeft -= wait;
+            for (uint16_t k = 0; k < 4; ++k) {
+                next.resources[k] += wait * state.robots[k] - plans[i][k];
             }
+            ++next.robots[i];
+            dfs(next);
         }
-        world.update();
-        pushQ(world);
     }
-    return maxGeods;
+
+    const RobotPlans& plans;
+    Resources caps{};
+    uint16_t best{};
+};
+
+struct Result
+{
+    uint16_t maxGeods{};
+    std::chrono::high_resolution_clock::duration elapsedTime{};
+};
+
+// Evaluates the first count blueprints in parallel, each worker takes the next blueprint not yet started
+static std::vector<Result> evaluate(const BluePrints& blueprints, size_t count, uint16_t maxSteps)
+{
+    count = std::min(count, blueprints.size());
+    std::vector<Result> results(count);
+    std::atomic<size_t> next{0};
+    std::vector<std::thread> workers{};
+    const auto threads{std::max<size_t>(1, std::min<size_t>(std::thread::hardware_concurrency(), count))};
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&] {
+            for (auto i = next++; i < count; i = next++) {
+                auto startTime = std::chrono::high_resolution_clock::now();
+                results[i].maxGeods = GeodeSearch{blueprints[i]}.run(maxSteps);
+                results[i].elapsedTime = std::chrono::high_resolution_clock::now() - startTime;
+            }
+        });
+    }
+    std::for_each(workers.begin(), workers.end(), [](auto& worker) { worker.join(); });
+    return results;
 }
 
 int main(int argc, char* argv[])
@@ -198,16 +206,13 @@ int main(int argc, char* argv[])
             std::cout << "=== PUZZLE A ===" << std::endl;
         }
         size_t sum{};
-        for (const auto& blueprint : blueprints) {
-            auto startTime = std::chrono::high_resolution_clock::now();
-            auto maxGeods = bfs(blueprint, 24);
-            auto endTime = std::chrono::high_resolution_clock::now();
-            auto elapsedTime = endTime - startTime;
+        const auto results{evaluate(blueprints, blueprints.size(), 24)};
+        for (size_t i = 0; i < results.size(); ++i) {
             if (benchmark) {
-                std::cout << "BluePrint [" << blueprint.id << "]: " << maxGeods << " ("
-                          << elapsedTime / std::chrono::milliseconds(1) << " ms)" << std::endl;
+                std::cout << "BluePrint [" << blueprints[i].id << "]: " << results[i].maxGeods << " ("
+                          << results[i].elapsedTime / std::chrono::milliseconds(1) << " ms)" << std::endl;
             }
-            sum += blueprint.id * maxGeods;
+            sum += blueprints[i].id * results[i].maxGeods;
         }
         if (benchmark) {
             std::cout << std::endl;
@@ -219,16 +224,13 @@ int main(int argc, char* argv[])
             std::cout << "=== PUZZLE B ===" << std::endl;
         }
         size_t prod{1};
-        for (size_t i = 0; i < std::min<size_t>(3, blueprints.size()); ++i) {
-            auto startTime = std::chrono::high_resolution_clock::now();
-            auto maxGeods = bfs(blueprints[i], 32);
-            auto endTime = std::chrono::high_resolution_clock::now();
-            auto elapsedTime = endTime - startTime;
+        const auto results{evaluate(blueprints, 3, 32)};
+        for (size_t i = 0; i < results.size(); ++i) {
             if (benchmark) {
-                std::cout << "BluePrint [" << blueprints[i].id << "]: " << maxGeods << " ("
-                          << elapsedTime / std::chrono::milliseconds(1) << " ms)" << std::endl;
+                std::cout << "BluePrint [" << blueprints[i].id << "]: " << results[i].maxGeods << " ("
+                          << results[i].elapsedTime / std::chrono::milliseconds(1) << " ms)" << std::endl;
             }
-            prod *= maxGeods;
+            prod *= results[i].maxGeods;
         }
         if (benchmark) {
             std::cout << std::endl;
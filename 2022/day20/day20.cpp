@@ -3,9 +3,10 @@
 // https://adventofcode.com/2022/day/20
 
 #include <algorithm>
+#include <cstdint>
 #include <fstream>
 #include <iostream>
-#include <numeric>
+#include <random>
 #include <string>
 #include <vector>
 
@@ -26,37 +27,143 @@ static bool readFile(std::string fileName, std::vector<std::string>& lines)
     return true;
 }
 
-template <typename T>
-void move(std::vector<T>& v, size_t oldIndex, size_t newIndex)
+constexpr uint32_t none{UINT32_MAX};
+
+// Implicit treap over the element ids with parent links, giving the position of an element in O(log n)
+class MixList
 {
-    if (oldIndex > newIndex) {
-        std::rotate(v.rend() - oldIndex - 1, v.rend() - oldIndex, v.rend() - newIndex);
-    } else {
-        std::rotate(v.begin() + oldIndex, v.begin() + oldIndex + 1, v.begin() + newIndex + 1);
+public:
+    MixList(size_t n) : nodes(n)
+    {
+        std::mt19937 mt(20);
+        for (uint32_t i = 0; i < n; ++i) {
+            nodes[i].prio = mt();
+            root = merge(root, i);
+        }
     }
-}
 
-int32_t mix(const std::vector<int32_t>& v, int32_t scale = 1, size_t loopCount = 1)
-{
-    std::vector<int32_t> vIndex(v.size());
-    std::iota(vIndex.begin(), vIndex.end(), 0);
-    const int32_t div{static_cast<int32_t>(v.size() - 1)};
-    size_t count{};
-    do {
-        for (size_t i = 0; i < v.size(); ++i) {
-            const auto oldIndex = static_cast<int32_t>(std::find(vIndex.begin(), vIndex.end(), i) - vIndex.begin());
-            auto newIndex = oldIndex + v[i] % div * scale;
-            if (newIndex < 0 || newIndex > div) {
-                newIndex = (newIndex % div + div) % div;
+    size_t position(uint32_t x) const
+    {
+        auto pos{size(nodes[x].left)};
+        for (auto p = nodes[x].parent; p != none; x = p, p = nodes[p].parent) {
+            if (nodes[p].right == x) {
+                pos += size(nodes[p].left) + 1;
             }
-            move<int32_t>(vIndex, static_cast<size_t>(oldIndex), static_cast<size_t>(newIndex));
         }
-    } while (++count < loopCount);
-    auto zeroIndex = static_cast<int32_t>(std::find(v.begin(), v.end(), 0) - v.begin());
-    zeroIndex = static_cast<int32_t>(std::find(vIndex.begin(), vIndex.end(), zeroIndex) - vIndex.begin());
-    int32_t level{};
+        return pos;
+    }
+
+    uint32_t at(size_t pos) const
+    {
+        auto t{root};
+        while (true) {
+            const auto leftSize{size(nodes[t].left)};
+            if (pos < leftSize) {
+                t = nodes[t].left;
+            } else if (pos == leftSize) {
+                return t;
+            } else {
+                pos -= leftSize + 1;
+                t = nodes[t].right;
+            }
+        }
+    }
+
+    void move(uint32_t x, size_t newPos)
+    {
+        const auto oldPos{position(x)};
+        auto [a, bc] = split(root, oldPos);
+        auto [b, c] = split(bc, 1);
+        auto [d, e] = split(merge(a, c), newPos);
+        root = merge(merge(d, b), e);
+        nodes[root].parent = none;
+    }
+
+private:
+    struct Node
+    {
+        uint32_t left{none};
+        uint32_t right{none};
+        uint32_t parent{none};
+        uint32_t size{1};
+        uint32_t prio{0};
+    };
+
+    uint32_t size(uint32_t t) const
+    {
+        return t == none ? 0 : nodes[t].size;
+    }
+
+    void update(uint32_t t)
+    {
+        auto& node = nodes[t];
+        node.size = size(node.left) + size(node.right) + 1;
+        if (node.left != none) {
+            nodes[node.left].parent = t;
+        }
+        if (node.right != none) {
+            nodes[node.right].parent = t;
+        }
+    }
+
+    // Splits off the first k elements
+    std::pair<uint32_t, uint32_t> split(uint32_t t, size_t k)
+    {
+        if (t == none) {
+            return {none, none};
+        }
+        nodes[t].parent = none;
+        if (size(nodes[t].left) >= k) {
+            const auto [a, b] = split(nodes[t].left, k);
+            nodes[t].left = b;
+            update(t);
+            return {a, t};
+        }
+        const auto [a, b] = split(nodes[t].right, k - size(nodes[t].left) - 1);
+        nodes[t].right = a;
+        update(t);
+        return {t, b};
+    }
+
+    uint32_t merge(uint32_t a, uint32_t b)
+    {
+        if (a == none || b == none) {
+            return a == none ? b : a;
+        }
+        if (nodes[a].prio > nodes[b].prio) {
+            nodes[a].right = merge(nodes[a].right, b);
+            update(a);
+            return a;
+        }
+        nodes[b].left = merge(a, nodes[b].left);
+        update(b);
+        return b;
+    }
+
+    std::vector<Node> nodes;
+    uint32_t root{none};
+};
+
+// Mixes in O(n log n) per round, moves are taken modulo n - 1 as the moved element is not in the list
+int64_t mix(const std::vector<int64_t>& v, int64_t key = 1, size_t loopCount = 1)
+{
+    const auto n{v.size()};
+    if (n < 2) {
+        return 0;
+    }
+    const auto div{static_cast<int64_t>(n - 1)};
+    MixList list{n};
+    for (size_t count = 0; count < loopCount; ++count) {
+        for (uint32_t i = 0; i < n; ++i) {
+            const auto shift{(v[i] % div) * (key % div) % div};
+            list.move(i, static_cast<size_t>(((static_cast<int64_t>(list.position(i)) + shift) % div + div) % div));
+        }
+    }
+    const auto zero{static_cast<uint32_t>(std::find(v.cbegin(), v.cend(), 0) - v.cbegin())};
+    const auto zeroIndex{list.position(zero)};
+    int64_t level{};
     for (size_t i = 1; i < 4; ++i) {
-        level += v[vIndex[(1000 * i + zeroIndex) % (div + 1)]];
+        level += v[list.at((1000 * i + zeroIndex) % n)] * key;
     }
     return level;
 }
@@ -70,19 +177,19 @@ int main(int argc, char* argv[])
         }
     }
 
-    std::vector<int32_t> v{};
+    std::vector<int64_t> v{};
     for (const auto& line : lines) {
-        v.push_back(std::stoi(line));
+        v.push_back(std::stoll(line));
+    }
+    if (std::find(v.cbegin(), v.cend(), 0) == v.cend()) {
+        return EXIT_FAILURE;
     }
 
     {  // Part 1
         std::cout << mix(v) << std::endl;
     }
     {  // Part 2
-        const int64_t div{static_cast<int64_t>(v.size() - 1)};
-        const int64_t code{811589153};
-        const int32_t scale{code % div};
-        std::cout << code * mix(v, scale, 10) << std::endl;
+        std::cout << mix(v, 811589153, 10) << std::endl;
     }
 
     return EXIT_SUCCESS;
@@ -3,13 +3,10 @@
 // https://adventofcode.com/2022/day/24
 
 #include <algorithm>
-#include <array>
+#include <cstdint>
 #include <fstream>
 #include <iostream>
-#include <map>
 #include <numeric>
-#include <queue>
-#include <set>
 #include <string>
 #include <vector>
 
@@ -30,107 +27,152 @@ static bool readFile(std::string fileName, std::vector<std::string>& lines)
     return true;
 }
 
-constexpr int8_t Ground{0};
-constexpr int8_t E{1};
-constexpr int8_t W{2};
-constexpr int8_t S{4};
-constexpr int16_t N{8};
-constexpr int16_t Wall{16};
-using Pos = std::array<uint16_t, 2>;
-using Map = std::vector<std::vector<uint16_t> >;
-using Maps = std::vector<Map>;
+using Row = std::vector<uint64_t>;
+using Rows = std::vector<Row>;
 
-struct World
+// dst |= src shifted by k columns towards higher columns, bits beyond the row are dropped by the caller
+static void orShiftedLeft(const Row& src, size_t k, Row& dst)
 {
-    World(const Pos& pos, uint16_t step = 0) : pos{pos}, step{step}
-    {
+    const auto words{k / 64};
+    const auto bits{k % 64};
+    for (size_t w = words; w < dst.size(); ++w) {
+        dst[w] |= src[w - words] << bits;
+        if (bits > 0 && w > words) {
+            dst[w] |= src[w - words - 1] >> (64 - bits);
+        }
     }
-    Pos pos{};
-    uint16_t step{};
+}
 
-    uint32_t hash() const
-    {
-        uint32_t hash{};
-        hash |= static_cast<uint32_t>(pos[0]);
-        hash |= static_cast<uint32_t>(pos[1]) << 8;
-        hash |= static_cast<uint32_t>(step) << 16;
-        return hash;
+// dst |= src shifted by k columns towards lower columns
+static void orShiftedRight(const Row& src, size_t k, Row& dst)
+{
+    const auto words{k / 64};
+    const auto bits{k % 64};
+    for (size_t w = 0; w + words < dst.size(); ++w) {
+        dst[w] |= src[w + words] >> bits;
+        if (bits > 0 && w + words + 1 < dst.size()) {
+            dst[w] |= src[w + words + 1] << (64 - bits);
+        }
     }
-};
+}
 
-void move(Map& map)
+// Valley interior as bitset rows, bit j of a row stands for column j, the walls are implicit
+class Valley
 {
-    Map next{map.size() - 2, std::vector<uint16_t>(map[0].size(), Ground)};
+public:
+    explicit Valley(const std::vector<std::string>& lines)
+        : height{lines.size() - 2},
+          width{lines[0].size() - 2},
+          words{(width + 63) / 64},
+          entry{lines.front().find('.') - 1},
+          exit{lines.back().find('.') - 1},
+          east(height, Row(words, 0)),
+          west(height, Row(words, 0)),
+          north(height, Row(words, 0)),
+          south(height, Row(words, 0)),
+          mask(words, UINT64_MAX)
     {
-        const std::vector<uint16_t> border(map[0].size(), Wall);
-        next.insert(next.begin(), border);
-        next.emplace_back(border);
-    }
-    const Pos dim{static_cast<uint16_t>(map.size()), static_cast<uint16_t>(map[0].size())};
-    for (uint16_t i = 1; i < dim[0] - 1; ++i) {
-        next[i][0] = Wall;
-        next[i][dim[1] - 1] = Wall;
-        for (uint16_t j = 1; j < dim[1] - 1; ++j) {
-            if (map[i][j] == Wall) {
-                next[i][j] = Wall;
-                continue;
-            }
-            if (i == dim[0] - 3 && map[2][j] & N || map[i + 1][j] & N) {
-                next[i][j] |= N;
+        if (width % 64 != 0) {
+            mask.back() = (uint64_t{1} << (width % 64)) - 1;
+        }
+        for (size_t i = 0; i < height; ++i) {
+            for (size_t j = 0; j < width; ++j) {
+                const auto bit{uint64_t{1} << (j % 64)};
+                switch (lines[i + 1][j + 1]) {
+                    case '>':
+                        east[i][j / 64] |= bit;
+                        break;
+                    case '<':
+                        west[i][j / 64] |= bit;
+                        break;
+                    case '^':
+                        north[i][j / 64] |= bit;
+                        break;
+                    case 'v':
+                        south[i][j / 64] |= bit;
+                        break;
+                    default:
+                        break;
+                }
             }
-            if (i == 2 && map[dim[0] - 3][j] & S || map[i - 1][j] & S) {
-                next[i][j] |= S;
+        }
+    }
+
+    // Minute of arrival when leaving the entry (down) or the exit (up) at the given minute, SIZE_MAX if unreachable
+    size_t cross(size_t time, bool down) const
+    {
+        const auto [fromRow, fromCol] = down ? std::pair(size_t{0}, entry) : std::pair(height - 1, exit);
+        const auto [toRow, toCol] = down ? std::pair(height - 1, exit) : std::pair(size_t{0}, entry);
+        // The blizzards repeat after period minutes, so the reachable cells can only grow from period to period
+        const auto period{std::lcm(height, width)};
+        Rows cur(height, Row(words, 0));
+        Rows next{cur};
+        Rows snapshot{cur};
+        Row free(words);
+        for (auto t = time;; ++t) {
+            if (cur[toRow][toCol / 64] & (uint64_t{1} << (toCol % 64))) {
+                return t + 1;
             }
-            if (j == dim[1] - 2 && map[i][1] & W || map[i][j + 1] & W) {
-                next[i][j] |= W;
+            if ((t - time) % period == 0) {
+                if (t > time && cur == snapshot) {
+                    return SIZE_MAX;
+                }
+                snapshot = cur;
             }
-            if (j == 1 && map[i][dim[1] - 2] & E || map[i][j - 1] & E) {
-                next[i][j] |= E;
+            // Dilate the reachable cells, then mask out the blizzards of the next minute
+            for (size_t i = 0; i < height; ++i) {
+                freeCells(i, t + 1, free);
+                auto& n = next[i];
+                n = cur[i];
+                orShiftedLeft(cur[i], 1, n);
+                orShiftedRight(cur[i], 1, n);
+                for (size_t w = 0; w < words; ++w) {
+                    if (i > 0) {
+                        n[w] |= cur[i - 1][w];
+                    }
+                    if (i + 1 < height) {
+                        n[w] |= cur[i + 1][w];
+                    }
+                    n[w] &= free[w];
+                }
+                // Waiting at the entrance is always possible
+                if (i == fromRow) {
+                    n[fromCol / 64] |= free[fromCol / 64] & (uint64_t{1} << (fromCol % 64));
+                }
             }
+            std::swap(cur, next);
         }
     }
-    map.swap(next);
-}
 
-inline int32_t manhattanDistance(const Pos& a, const Pos& b)
-{
-    return std::abs(a[0] - b[0]) + std::abs(a[1] - b[1]);
-}
-
-uint16_t dijkstra(const Maps& maps, const Pos& start, const Pos& end, uint16_t startStep = 0)
-{
-    std::set<uint32_t> visited{};
-    const auto period = static_cast<uint16_t>(maps.size());
-    constexpr std::array<std::array<int32_t, 2>, 5> adjs{{{0, 1}, {1, 0}, {0, -1}, {-1, 0}, {0, 0}}};
-    auto cmp = [&end](const auto& a, const auto& b) {
-        return a.step + manhattanDistance(a.pos, end) > b.step + manhattanDistance(b.pos, end);
-    };
-    std::priority_queue<World, std::vector<World>, decltype(cmp)> q(cmp);
-    q.push(std::move(World{start, startStep}));
-    auto pushQ = [&](const World&& next) {
-        const auto hash = next.hash();
-        if (visited.find(hash) == visited.end()) {
-            visited.insert(hash);
-            q.push(std::move(next));
-        }
-    };
-    while (!q.empty()) {
-        auto world = q.top();
-        if (world.pos == end) {
-            return world.step - startStep;
-        }
-        q.pop();
-        const auto [i, j] = world.pos;
-        const auto& map = maps[++world.step % period];
-        for (const auto [ai, aj] : adjs) {
-            Pos nextPos{static_cast<uint16_t>(i + ai), static_cast<uint16_t>(j + aj)};
-            if (map[nextPos[0]][nextPos[1]] == Ground) {
-                pushQ(World{nextPos, world.step});
-            }
+private:
+    // Cells of row i not hit by a blizzard at minute t, horizontal blizzards rotate within their row and vertical
+    // ones keep their row pattern, which moves up or down as a whole
+    void freeCells(size_t i, size_t t, Row& free) const
+    {
+        std::fill(free.begin(), free.end(), 0);
+        const auto shift{t % width};
+        orShiftedLeft(east[i], shift, free);
+        orShiftedRight(east[i], width - shift, free);
+        orShiftedRight(west[i], shift, free);
+        orShiftedLeft(west[i], width - shift, free);
+        const auto& n = north[(i + t) % height];
+        const auto& s = south[(i + height - t % height) % height];
+        for (size_t w = 0; w < words; ++w) {
+            free[w] = ~(free[w] | n[w] | s[w]) & mask[w];
         }
     }
-    return UINT16_MAX;
-}
+
+    size_t height;
+    size_t width;
+    size_t words;
+    size_t entry;
+    size_t exit;
+    Rows east;
+    Rows west;
+    Rows north;
+    Rows south;
+    Row mask;
+};
 
 int main(int argc, char* argv[])
 {
@@ -141,48 +183,29 @@ int main(int argc, char* argv[])
         }
     }
 
-    const Pos dim{static_cast<uint16_t>(lines.size()), static_cast<uint16_t>(lines[0].size())};
-    Map map{static_cast<size_t>(dim[0]), std::vector<uint16_t>(dim[1], Ground)};
-
-    for (uint16_t i = 0; i < dim[0]; ++i) {
-        for (uint16_t j = 0; j < dim[1]; ++j) {
-            if (lines[i][j] == '>') {
-                map[i][j] = E;
-            } else if (lines[i][j] == '<') {
-                map[i][j] = W;
-            } else if (lines[i][j] == '^') {
-                map[i][j] = N;
-            } else if (lines[i][j] == 'v') {
-                map[i][j] = S;
-            } else if (lines[i][j] == '#') {
-                map[i][j] = Wall;
-            }
-        }
-    }
-    {
-        const std::vector<uint16_t> border(dim[1], Wall);
-        map.insert(map.begin(), border);
-        map.emplace_back(border);
-    }
-
-    // Precalculate all possible map states based on the lcm of the grid dimensions
-    Maps maps{};
-    maps.push_back(map);
-    for (int i = 1; i < std::lcm(dim[0] - 2, dim[1] - 2); ++i) {
-        move(map);
-        maps.push_back(map);
+    if (lines.size() < 3 || lines[0].size() < 3 || lines.front().find('.') == std::string::npos ||
+        lines.back().find('.') == std::string::npos) {
+        return EXIT_FAILURE;
     }
 
-    constexpr Pos start{1, 1};
-    const Pos end{static_cast<uint16_t>(dim[0]), static_cast<uint16_t>(dim[1] - 2)};
-    uint16_t count{};
+    const Valley valley{lines};
+    size_t count{};
     {  // Part 1
-        count = dijkstra(maps, start, end);
+        count = valley.cross(0, true);
+        if (count == SIZE_MAX) {
+            return EXIT_FAILURE;
+        }
         std::cout << count << std::endl;
     }
     {  // Part 2
-        count += dijkstra(maps, end, start, count);
-        count += dijkstra(maps, start, end, count);
+        count = valley.cross(count, false);
+        if (count == SIZE_MAX) {
+            return EXIT_FAILURE;
+        }
+        count = valley.cross(count, true);
+        if (count == SIZE_MAX) {
+            return EXIT_FAILURE;
+        }
         std::cout << count << std::endl;
     }
 